@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+
+// Heap allocation counting for benchmark and test builds.
+//
+// With SQLDB_COUNT_ALLOCATIONS defined and bench/alloc_counter.cpp linked in, the global
+// operator new/delete are replaced by versions that count calls and requested bytes on
+// the calling thread. Without it everything below reports zero and enabled() is false,
+// so budget checks can be skipped.
+//
+//   bench::AllocScope scope;
+//   table.getById(42);
+//   auto used = scope.delta(); // used.allocations, used.bytes
+
+namespace bench {
+
+struct AllocCounts {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t bytes = 0; // Requested bytes, not allocator footprint
+};
+
+#if defined(SQLDB_COUNT_ALLOCATIONS)
+AllocCounts threadAllocCounts();
+inline constexpr bool allocCountingEnabled = true;
+#else
+inline AllocCounts threadAllocCounts() { return {}; }
+inline constexpr bool allocCountingEnabled = false;
+#endif
+
+// Allocations made by the current thread since construction
+class AllocScope {
+    AllocCounts start;
+public:
+    AllocScope() : start(threadAllocCounts()) {}
+
+    AllocCounts delta() const {
+        AllocCounts now = threadAllocCounts();
+        return { now.allocations - start.allocations, now.frees - start.frees, now.bytes - start.bytes };
+    }
+};
+
+} // namespace bench
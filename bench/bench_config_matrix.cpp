@@ -0,0 +1,241 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "sqldb/sqldb.h"
+
+using namespace sqldb;
+
+// Runs a fixed set of workloads under every combination of journal mode, synchronous
+// mode and page size, each on a fresh file, and prints ops/s and p50/p99/p999 latency.
+// Usage: bench_config_matrix [--rows N] [--ops N] [--json out.json]
+
+struct MatrixConfig {
+    std::string label;
+    Config config;
+};
+
+struct MatrixResult {
+    std::string config;
+    std::string workload;
+    size_t ops = 0;
+    double seconds = 0.0;
+    double p50 = 0.0, p99 = 0.0, p999 = 0.0; // Microseconds
+
+    double opsPerSecond() const { return seconds > 0 ? ops / seconds : 0.0; }
+};
+
+static const char* syncName(SyncMode mode) {
+    switch (mode) {
+        case SyncMode::OFF: return "OFF";
+        case SyncMode::NORMAL: return "NORMAL";
+        case SyncMode::FULL: return "FULL";
+        case SyncMode::EXTRA: return "EXTRA";
+    }
+    return "?";
+}
+
+static std::vector<MatrixConfig> buildMatrix() {
+    std::vector<MatrixConfig> matrix;
+    for (bool wal : {true, false}) {
+        for (SyncMode sync : {SyncMode::OFF, SyncMode::NORMAL, SyncMode::FULL}) {
+            for (int pageSize : {4096, 16384}) {
+                Config cfg;
+                cfg.enableWAL = wal;
+                cfg.synchronous = sync;
+                cfg.pageSize = pageSize;
+                std::string label = std::string(wal ? "WAL" : "DELETE") + "/" + syncName(sync) + "/" +
+                                    std::to_string(pageSize / 1024) + "K";
+                matrix.push_back({label, cfg});
+            }
+        }
+    }
+    return matrix;
+}
+
+// Times 'ops' calls of 'op(i)' individually
+static MatrixResult measure(const std::string& config, const std::string& workload, size_t ops,
+                            const std::function<void(size_t)>& op) {
+    std::vector<double> micros;
+    micros.reserve(ops);
+    auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ops; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        op(i);
+        micros.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    MatrixResult r;
+    r.config = config;
+    r.workload = workload;
+    r.ops = ops;
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::sort(micros.begin(), micros.end());
+    if (!micros.empty()) {
+        auto at = [&](double q) { return micros[std::min(micros.size() - 1, static_cast<size_t>(q * micros.size()))]; };
+        r.p50 = at(0.50);
+        r.p99 = at(0.99);
+        r.p999 = at(0.999);
+    }
+    return r;
+}
+
+static void removeDbFiles(const std::string& file) {
+    for (const char* suffix : {"", "-wal", "-shm", "-journal"}) std::remove((file + suffix).c_str());
+}
+
+static std::vector<MatrixResult> runConfig(const MatrixConfig& mc, size_t rows, size_t ops) {
+    const std::string file = "bench_matrix.db";
+    removeDbFiles(file);
+    std::vector<MatrixResult> results;
+    {
+        Database db(file, mc.config);
+        auto& users = db.defineTable("bench_users");
+        users.addColumn("id", SQLType::INTEGER, true, true)
+             .addColumn("username", SQLType::TEXT)
+             .addColumn("age", SQLType::INTEGER)
+             .addColumn("score", SQLType::REAL)
+             .create();
+        auto& parents = db.defineTable("bench_parents");
+        parents.addColumn("id", SQLType::INTEGER, true, true)
+               .addColumn("name", SQLType::TEXT)
+               .create();
+        auto& children = db.defineTable("bench_children");
+        children.addColumn("id", SQLType::INTEGER, true, true)
+                .addColumn("payload", SQLType::TEXT)
+                .addForeignKey("parent_id", SQLType::INTEGER, "bench_parents", "id", true)
+                .indexForeignKeys()
+                .create();
+
+        {
+            auto txn = db.transaction();
+            for (size_t i = 0; i < rows; ++i) {
+                users.insert({ {"username", "user" + std::to_string(i)}, {"age", (long long)(i % 100)},
+                               {"score", (i % 1000) / 10.0} });
+            }
+            for (size_t p = 0; p < ops; ++p) {
+                long long parentId = parents.insert({ {"name", "parent" + std::to_string(p)} });
+                for (int c = 0; c < 5; ++c) children.insert({ {"parent_id", parentId}, {"payload", "child"} });
+            }
+            txn.commit();
+        }
+
+        std::mt19937_64 rng(42);
+        auto randomId = [&] { return static_cast<long long>(1 + rng() % rows); };
+
+        results.push_back(measure(mc.label, "point_read", ops, [&](size_t) {
+            users.getById(randomId());
+        }));
+
+        QueryOptions range;
+        range.limit = 100;
+        results.push_back(measure(mc.label, "range_scan", ops / 10, [&](size_t) {
+            users.select({ Condition{"id", Op::GT, randomId()} }, range);
+        }));
+
+        results.push_back(measure(mc.label, "single_insert", ops, [&](size_t i) {
+            users.insert({ {"username", "single" + std::to_string(i)}, {"age", 1LL}, {"score", 1.0} });
+        }));
+
+        const size_t BATCH = 100;
+        results.push_back(measure(mc.label, "batch_insert_x100", ops / 10, [&](size_t i) {
+            auto txn = db.transaction();
+            for (size_t j = 0; j < BATCH; ++j) {
+                users.insert({ {"username", "batch" + std::to_string(i * BATCH + j)}, {"age", 2LL}, {"score", 2.0} });
+            }
+            txn.commit();
+        }));
+
+        results.push_back(measure(mc.label, "mixed_90_10", ops, [&](size_t) {
+            long long id = randomId();
+            if (rng() % 10 == 0) {
+                users.update({ {"score", static_cast<double>(rng() % 1000)} }, { Condition{"id", Op::EQ, id} });
+            } else {
+                users.getById(id);
+            }
+        }));
+
+        results.push_back(measure(mc.label, "cascade_delete", ops, [&](size_t i) {
+            parents.remove({ Condition{"id", Op::EQ, static_cast<long long>(i + 1)} });
+        }));
+    }
+    removeDbFiles(file);
+    return results;
+}
+
+static void printTable(const std::vector<MatrixResult>& results) {
+    std::string workload;
+    for (const auto& r : results) {
+        if (r.workload != workload) {
+            workload = r.workload;
+            std::cout << "\n" << workload << "\n"
+                      << std::left << std::setw(20) << "config" << std::right
+                      << std::setw(12) << "ops/s" << std::setw(12) << "p50 us"
+                      << std::setw(12) << "p99 us" << std::setw(12) << "p999 us" << "\n";
+        }
+        std::cout << std::left << std::setw(20) << r.config << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << r.opsPerSecond() << std::setw(12) << r.p50
+                  << std::setw(12) << r.p99 << std::setw(12) << r.p999 << "\n";
+    }
+    std::cout << std::defaultfloat << std::flush;
+}
+
+static std::string toJson(const std::vector<MatrixResult>& results, size_t rows, size_t ops) {
+    std::ostringstream out;
+    out << "{\n  \"sqlite_version\": \"" << sqlite3_libversion() << "\",\n"
+        << "  \"rows\": " << rows << ",\n  \"ops\": " << ops << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    {\"config\": \"" << r.config << "\", \"workload\": \"" << r.workload
+            << "\", \"ops\": " << r.ops << ", \"seconds\": " << r.seconds
+            << ", \"ops_per_sec\": " << r.opsPerSecond() << ", \"p50_us\": " << r.p50
+            << ", \"p99_us\": " << r.p99 << ", \"p999_us\": " << r.p999 << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+int main(int argc, char** argv) {
+    size_t rows = 20000;
+    size_t ops = 2000;
+    std::string jsonFile;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--rows") && i + 1 < argc) rows = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--ops") && i + 1 < argc) ops = std::strtoull(argv[++i], nullptr, 10);
+        else if (!std::strcmp(argv[i], "--json") && i + 1 < argc) jsonFile = argv[++i];
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--rows N] [--ops N] [--json out.json]" << std::endl;
+            return 1;
+        }
+    }
+    if (rows == 0 || ops < 10) {
+        std::cerr << "--rows must be positive and --ops at least 10" << std::endl;
+        return 1;
+    }
+
+    std::vector<MatrixResult> results;
+    for (const auto& mc : buildMatrix()) {
+        std::cout << "Running " << mc.label << "..." << std::endl;
+        auto r = runConfig(mc, rows, ops);
+        results.insert(results.end(), r.begin(), r.end());
+    }
+    std::stable_sort(results.begin(), results.end(),
+                     [](const MatrixResult& a, const MatrixResult& b) { return a.workload < b.workload; });
+    printTable(results);
+
+    if (!jsonFile.empty()) {
+        std::ofstream out(jsonFile);
+        out << toJson(results, rows, ops);
+        std::cout << "Wrote " << jsonFile << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <string>
+#include <vector>
+#include "bench_harness.h"
+#include "sqldb/sqldb.h"
+
+using namespace sqldb;
+
+// Core Table operations on an in-memory bench_users table, so the numbers measure
+// sqldb and SQLite's B-tree code rather than the disk.
+
+namespace {
+
+struct BenchRow {
+    long long id;
+    std::string username;
+    std::string email;
+    int age;
+    double score;
+};
+
+const long long FIXTURE_ROWS = 10000;
+
+struct Fixture {
+    Database db{":memory:"};
+    Table* users = nullptr;
+    long long nextId = FIXTURE_ROWS + 1;
+
+    Fixture() {
+        users = &db.defineTable("bench_users");
+        users->addColumn("id", SQLType::INTEGER, true, true)
+              .addColumn("username", SQLType::TEXT)
+              .addColumn("email", SQLType::TEXT)
+              .addColumn("age", SQLType::INTEGER)
+              .addColumn("score", SQLType::REAL)
+              .create();
+        auto txn = db.transaction();
+        for (long long i = 1; i <= FIXTURE_ROWS; ++i) {
+            users->insert({ {"username", "user" + std::to_string(i)}, {"email", "user" + std::to_string(i) + "@example.com"},
+                            {"age", i % 100}, {"score", (i % 1000) / 10.0} });
+        }
+        txn.commit();
+    }
+};
+
+Fixture& fixture() {
+    static Fixture f;
+    return f;
+}
+
+// Spreads consecutive iterations over the table
+long long keyFor(size_t i) {
+    return 1 + static_cast<long long>((i * 7919) % FIXTURE_ROWS);
+}
+
+} // namespace
+
+template<>
+struct sqldb::ORM<BenchRow> {
+    static constexpr const char* table = "bench_users";
+    static auto map() {
+        return std::make_tuple(
+            orm_field(&BenchRow::id, "id"),
+            orm_field(&BenchRow::username, "username"),
+            orm_field(&BenchRow::email, "email"),
+            orm_field(&BenchRow::age, "age"),
+            orm_field(&BenchRow::score, "score")
+        );
+    }
+};
+
+SQLDB_BENCHMARK("select/point") {
+    auto& users = *fixture().users;
+    for (size_t i = 0; i < iterations; ++i) {
+        users.select({ Condition{"id", Op::EQ, keyFor(i)} });
+    }
+}
+
+SQLDB_BENCHMARK("select/range100") {
+    auto& users = *fixture().users;
+    QueryOptions opts;
+    opts.limit = 100;
+    for (size_t i = 0; i < iterations; ++i) {
+        users.select({ Condition{"id", Op::GT, keyFor(i) % (FIXTURE_ROWS - 100)} }, opts);
+    }
+}
+
+// Same as select/point with per-phase latency recording on, to keep its cost visible
+SQLDB_BENCHMARK("select/point+metrics") {
+    auto& f = fixture();
+    f.db.enableMetrics();
+    for (size_t i = 0; i < iterations; ++i) {
+        f.users->select({ Condition{"id", Op::EQ, keyFor(i)} });
+    }
+    f.db.disableMetrics();
+}
+
+SQLDB_BENCHMARK("select/getById") {
+    auto& users = *fixture().users;
+    for (size_t i = 0; i < iterations; ++i) users.getById(keyFor(i));
+}
+
+SQLDB_BENCHMARK("query<T>/point") {
+    auto& users = *fixture().users;
+    for (size_t i = 0; i < iterations; ++i) {
+        users.query<BenchRow>({ Condition{"id", Op::EQ, keyFor(i)} });
+    }
+}
+
+SQLDB_BENCHMARK("query<T>/range100") {
+    auto& users = *fixture().users;
+    QueryOptions opts;
+    opts.limit = 100;
+    for (size_t i = 0; i < iterations; ++i) {
+        users.query<BenchRow>({ Condition{"id", Op::GT, keyFor(i) % (FIXTURE_ROWS - 100)} }, opts);
+    }
+}
+
+SQLDB_BENCHMARK("update/point") {
+    auto& users = *fixture().users;
+    for (size_t i = 0; i < iterations; ++i) {
+        users.update({ {"score", static_cast<double>(i % 1000)} }, { Condition{"id", Op::EQ, keyFor(i)} });
+    }
+}
+
+// New rows are deleted again at the end of each sample so the table keeps its size;
+// the delete is amortized into the per-insert time
+SQLDB_BENCHMARK("insert/row") {
+    auto& f = fixture();
+    for (size_t i = 0; i < iterations; ++i) {
+        f.users->insert({ {"username", "new"}, {"email", "new@example.com"}, {"age", 30}, {"score", 50.0} });
+    }
+    f.users->remove({ Condition{"id", Op::GT, FIXTURE_ROWS} });
+}
+
+SQLDB_BENCHMARK("insert/struct") {
+    auto& f = fixture();
+    for (size_t i = 0; i < iterations; ++i) {
+        f.users->insert(BenchRow{ f.nextId++, "new", "new@example.com", 30, 50.0 });
+    }
+    f.users->remove({ Condition{"id", Op::GT, FIXTURE_ROWS} });
+}
@@ -0,0 +1,273 @@
+#pragma once
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include "alloc_counter.h"
+
+// Minimal microbenchmark harness for the `bench` target.
+//
+// A benchmark is a function that performs the measured operation 'iterations' times.
+// The runner calibrates 'iterations' until one sample takes at least minSampleTime,
+// discards 'warmup' samples, then reports median / MAD / p10 / p90 of the per-operation
+// time over 'repetitions' samples. Results can be saved as a baseline and later runs
+// compared against it; a median slower than the baseline by more than 'threshold'
+// is a regression and makes the run exit non-zero. In builds with SQLDB_COUNT_ALLOCATIONS
+// the heap allocations per operation are reported too, and any increase over the
+// baseline's count is also a regression.
+//
+//   SQLDB_BENCHMARK("select/point") {
+//       for (size_t i = 0; i < iterations; ++i) table.getById(1 + i % rows);
+//   }
+
+namespace bench {
+
+using BenchFn = std::function<void(size_t iterations)>;
+
+struct Benchmark {
+    std::string name; // No whitespace; '/' separates groups
+    BenchFn run;
+};
+
+inline std::vector<Benchmark>& registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+struct Registrar {
+    Registrar(const std::string& name, BenchFn run) {
+        registry().push_back({name, std::move(run)});
+    }
+};
+
+struct Stats {
+    size_t iterations = 0; // Operations per sample
+    size_t samples = 0;
+    double median = 0.0;   // Nanoseconds per operation
+    double mad = 0.0;      // Median absolute deviation from the median
+    double p10 = 0.0, p90 = 0.0;
+    double min = 0.0, max = 0.0;
+    double allocsPerOp = 0.0; // Over the measured samples, calling thread only
+    double bytesPerOp = 0.0;
+};
+
+// Linear-interpolated percentile of sorted values, q in [0, 1]
+inline double percentile(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    double pos = q * (sorted.size() - 1);
+    size_t lo = static_cast<size_t>(pos);
+    size_t hi = std::min(lo + 1, sorted.size() - 1);
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * (pos - lo);
+}
+
+inline Stats summarize(std::vector<double> perOp, size_t iterations) {
+    Stats s;
+    s.iterations = iterations;
+    s.samples = perOp.size();
+    if (perOp.empty()) return s;
+    std::sort(perOp.begin(), perOp.end());
+    s.median = percentile(perOp, 0.5);
+    s.p10 = percentile(perOp, 0.1);
+    s.p90 = percentile(perOp, 0.9);
+    s.min = perOp.front();
+    s.max = perOp.back();
+    std::vector<double> deviations;
+    deviations.reserve(perOp.size());
+    for (double v : perOp) deviations.push_back(std::fabs(v - s.median));
+    std::sort(deviations.begin(), deviations.end());
+    s.mad = percentile(deviations, 0.5);
+    return s;
+}
+
+struct Options {
+    int warmup = 2;
+    int repetitions = 15;
+    std::chrono::milliseconds minSampleTime{10};
+    std::string filter;        // Substring of the benchmark name
+    std::string baselineFile;  // Compare against this baseline
+    std::string saveFile;      // Write this run's medians as a baseline
+    double threshold = 0.10;   // Allowed median slowdown vs the baseline (0.10 = 10%)
+};
+
+// Wall time of one sample of 'iterations' operations, in nanoseconds
+inline double timeSample(const Benchmark& b, size_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    b.run(iterations);
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline Stats measure(const Benchmark& b, const Options& opts) {
+    double target = std::chrono::duration<double, std::nano>(opts.minSampleTime).count();
+    b.run(1); // Untimed: builds lazily created fixtures
+    size_t iterations = 1;
+    for (;;) {
+        double ns = timeSample(b, iterations);
+        if (ns >= target || iterations >= (size_t(1) << 30)) break;
+        // Aim slightly past the target so the next sample usually qualifies
+        double scale = ns > 0 ? 1.2 * target / ns : 10.0;
+        iterations = static_cast<size_t>(iterations * std::min(std::max(scale, 2.0), 100.0));
+    }
+    for (int i = 0; i < opts.warmup; ++i) timeSample(b, iterations);
+    std::vector<double> perOp;
+    perOp.reserve(opts.repetitions);
+    AllocScope allocs;
+    for (int i = 0; i < opts.repetitions; ++i) perOp.push_back(timeSample(b, iterations) / iterations);
+    AllocCounts used = allocs.delta();
+    // The sample vector was reserved up front, so only the benchmark's allocations remain
+    double ops = static_cast<double>(iterations) * opts.repetitions;
+    Stats s = summarize(std::move(perOp), iterations);
+    s.allocsPerOp = used.allocations / ops;
+    s.bytesPerOp = used.bytes / ops;
+    return s;
+}
+
+struct BaselineEntry {
+    double median = 0.0;
+    double allocsPerOp = -1.0; // -1 = not recorded
+};
+
+// "name median_ns mad_ns [allocs_per_op]" per line
+inline std::map<std::string, BaselineEntry> loadBaseline(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Cannot open baseline " + path);
+    std::map<std::string, BaselineEntry> entries;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string name;
+        BaselineEntry e;
+        double mad = 0.0;
+        if (line.empty() || line[0] == '#' || !(fields >> name >> e.median >> mad)) continue;
+        if (!(fields >> e.allocsPerOp)) e.allocsPerOp = -1.0;
+        entries[name] = e;
+    }
+    return entries;
+}
+
+inline void saveBaseline(const std::string& path, const std::vector<std::pair<std::string, Stats>>& results) {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("Cannot write baseline " + path);
+    out << (allocCountingEnabled ? "# name median_ns mad_ns allocs_per_op\n" : "# name median_ns mad_ns\n");
+    for (const auto& [name, s] : results) {
+        out << name << " " << s.median << " " << s.mad;
+        if (allocCountingEnabled) out << " " << s.allocsPerOp;
+        out << "\n";
+    }
+}
+
+inline bool parseOptions(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char* arg = argv[i];
+        const char* value = nullptr;
+        if (!std::strcmp(arg, "--warmup") && (value = next())) opts.warmup = std::atoi(value);
+        else if (!std::strcmp(arg, "--repetitions") && (value = next())) opts.repetitions = std::max(1, std::atoi(value));
+        else if (!std::strcmp(arg, "--min-sample-ms") && (value = next())) opts.minSampleTime = std::chrono::milliseconds(std::atoi(value));
+        else if (!std::strcmp(arg, "--filter") && (value = next())) opts.filter = value;
+        else if (!std::strcmp(arg, "--baseline") && (value = next())) opts.baselineFile = value;
+        else if (!std::strcmp(arg, "--save-baseline") && (value = next())) opts.saveFile = value;
+        else if (!std::strcmp(arg, "--threshold") && (value = next())) opts.threshold = std::atof(value);
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--filter substr] [--warmup N] [--repetitions N]"
+                      << " [--min-sample-ms N] [--baseline file] [--save-baseline file] [--threshold 0.10]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Runs every registered benchmark matching opts.filter. Returns the number of regressions
+// against the baseline (0 without one).
+inline int runAll(const Options& opts) {
+    std::map<std::string, BaselineEntry> baseline;
+    if (!opts.baselineFile.empty()) baseline = loadBaseline(opts.baselineFile);
+
+    std::cout << std::left << std::setw(32) << "benchmark" << std::right
+              << std::setw(10) << "iters" << std::setw(12) << "median ns" << std::setw(9) << "MAD %"
+              << std::setw(12) << "p10 ns" << std::setw(12) << "p90 ns";
+    if (allocCountingEnabled) std::cout << std::setw(11) << "allocs/op" << std::setw(10) << "B/op";
+    std::cout << (baseline.empty() ? "" : "   vs baseline") << "\n";
+
+    std::vector<std::pair<std::string, Stats>> results;
+    int regressions = 0;
+    for (const auto& b : registry()) {
+        if (!opts.filter.empty() && b.name.find(opts.filter) == std::string::npos) continue;
+        Stats s = measure(b, opts);
+        results.emplace_back(b.name, s);
+        std::cout << std::left << std::setw(32) << b.name << std::right << std::fixed
+                  << std::setw(10) << s.iterations
+                  << std::setprecision(1) << std::setw(12) << s.median
+                  << std::setw(9) << (s.median > 0 ? 100.0 * s.mad / s.median : 0.0)
+                  << std::setw(12) << s.p10 << std::setw(12) << s.p90;
+        if (allocCountingEnabled) {
+            std::cout << std::setprecision(2) << std::setw(11) << s.allocsPerOp
+                      << std::setprecision(0) << std::setw(10) << s.bytesPerOp;
+        }
+        auto base = baseline.find(b.name);
+        if (base != baseline.end() && base->second.median > 0) {
+            double change = s.median / base->second.median - 1.0;
+            bool slower = change > opts.threshold;
+            // Counts are deterministic up to the per-sample setup amortized into them
+            bool moreAllocs = allocCountingEnabled && base->second.allocsPerOp >= 0
+                              && s.allocsPerOp > base->second.allocsPerOp + 0.5;
+            regressions += slower || moreAllocs;
+            std::cout << "   " << std::showpos << std::setprecision(1) << 100.0 * change << "%" << std::noshowpos
+                      << (slower ? "  REGRESSION" : "")
+                      << (moreAllocs ? "  MORE ALLOCATIONS" : "");
+        } else if (!baseline.empty()) {
+            std::cout << "   (new)";
+        }
+        std::cout << std::defaultfloat << std::setprecision(6) << std::endl;
+    }
+
+    // Benchmarks named "<group>/raw" are the reference for their "<group>/..." siblings
+    bool header = false;
+    for (const auto& [refName, ref] : results) {
+        const std::string suffix = "/raw";
+        if (refName.size() <= suffix.size() || refName.compare(refName.size() - suffix.size(), suffix.size(), suffix) != 0) continue;
+        std::string group = refName.substr(0, refName.size() - suffix.size() + 1);
+        for (const auto& [name, s] : results) {
+            if (name == refName || name.compare(0, group.size(), group) != 0 || ref.median <= 0) continue;
+            if (!header) {
+                std::cout << "\nOverhead vs raw SQLite (median ratio)\n";
+                header = true;
+            }
+            std::cout << "  " << std::left << std::setw(40) << name << std::right << std::fixed
+                      << std::setprecision(2) << s.median / ref.median << "x"
+                      << std::defaultfloat << std::setprecision(6) << "\n";
+        }
+    }
+    if (header) std::cout << std::flush;
+
+    if (!opts.saveFile.empty()) {
+        saveBaseline(opts.saveFile, results);
+        std::cout << "Saved baseline to " << opts.saveFile << std::endl;
+    }
+    if (regressions) {
+        std::cout << regressions << " benchmark(s) slower than the baseline by more than "
+                  << opts.threshold * 100.0 << "% or allocating more" << std::endl;
+    }
+    return regressions;
+}
+
+} // namespace bench
+
+#define SQLDB_BENCH_CONCAT_(a, b) a##b
+#define SQLDB_BENCH_CONCAT(a, b) SQLDB_BENCH_CONCAT_(a, b)
+
+// Defines and registers a benchmark body; 'iterations' is in scope inside the body
+#define SQLDB_BENCHMARK(name)                                                                      \
+    static void SQLDB_BENCH_CONCAT(sqldbBench_, __LINE__)(size_t iterations);                     \
+    static ::bench::Registrar SQLDB_BENCH_CONCAT(sqldbBenchRegistrar_, __LINE__)(                 \
+        name, SQLDB_BENCH_CONCAT(sqldbBench_, __LINE__));                                          \
+    static void SQLDB_BENCH_CONCAT(sqldbBench_, __LINE__)(size_t iterations)
@@ -0,0 +1,51 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include "sqldb/sqldb.h"
+
+using namespace sqldb;
+
+// Generates a synthetic bench_users-shaped CSV and imports it with the parallel
+// importer, once single-threaded and once with the default thread pool.
+// Usage: bench_import [rows]
+int main(int argc, char** argv) {
+    const size_t rows = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const std::string csvFile = "bench_import.csv";
+    const std::string dbFile = "bench_import.db";
+
+    std::cout << "Generating " << rows << " rows into " << csvFile << "..." << std::endl;
+    {
+        std::ofstream out(csvFile, std::ios::binary);
+        out << "username,email,age,score\n";
+        for (size_t i = 0; i < rows; ++i) {
+            out << "User" << i << ",\"user" << i << "@example.com\"," << i % 100 << "," << (i % 1000) / 10.0 << "\n";
+        }
+    }
+
+    for (unsigned threads : {1u, 0u}) {
+        std::remove(dbFile.c_str());
+        Database db(dbFile);
+        auto& users = db.defineTable("bench_users");
+        users.addColumn("id", SQLType::INTEGER, true, true)
+             .addColumn("username", SQLType::TEXT)
+             .addColumn("email", SQLType::TEXT)
+             .addColumn("age", SQLType::INTEGER)
+             .addColumn("score", SQLType::REAL)
+             .create();
+
+        CsvOptions opts;
+        opts.threads = threads;
+        ImportStats stats = db.importCsv(users, csvFile, opts);
+        std::cout << "[Import] threads=" << (threads ? std::to_string(threads) : std::string("auto"))
+                  << " rows=" << stats.rows
+                  << " time=" << stats.seconds << " s"
+                  << " rows/s=" << static_cast<size_t>(stats.rowsPerSecond())
+                  << " MB/s=" << stats.mbPerSecond() << std::endl;
+    }
+
+    std::remove(dbFile.c_str());
+    std::remove(csvFile.c_str());
+    return 0;
+}
@@ -0,0 +1,169 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "sqldb/sqldb.h"
+
+using namespace sqldb;
+
+// Mixed load on one connection: interactive threads run point lookups while batch
+// threads run long range scans. Runs twice, once with every thread at the same lock
+// priority (plain FIFO) and once with the scans under LockPriority::BATCH, and prints
+// the interactive latency percentiles, batch throughput and lock stats of each.
+//
+// Usage: bench_lock_priority [--records N] [--seconds S] [--interactive N] [--batch N]
+//                            [--scan-length N] [--batch-max-wait MS]
+
+struct PriorityOptions {
+    long long records = 50000;
+    double seconds = 3.0;
+    int interactiveThreads = 4;
+    int batchThreads = 2;
+    int scanLength = 5000;
+    int batchMaxWaitMs = 100;
+};
+
+struct PriorityResult {
+    LatencyHistogram interactive;
+    LatencyHistogram batch;
+    double seconds = 0.0;
+    LockStats lock;
+};
+
+static void loadRows(Database& db, long long records) {
+    auto& users = db.defineTable("bench_users");
+    users.addColumn("id", SQLType::INTEGER, true, true)
+         .addColumn("username", SQLType::TEXT)
+         .addColumn("age", SQLType::INTEGER)
+         .addColumn("score", SQLType::REAL)
+         .create();
+    auto txn = db.transaction();
+    for (long long i = 0; i < records; ++i) {
+        users.insert({ {"username", "user" + std::to_string(i)}, {"age", i % 100}, {"score", (i % 1000) / 10.0} });
+    }
+    txn.commit();
+}
+
+static PriorityResult runMixed(Database& db, const PriorityOptions& opts, bool prioritize) {
+    auto& users = db.getTable("bench_users");
+    std::atomic<bool> stop{false};
+    std::vector<LatencyHistogram> interactive(opts.interactiveThreads), batch(opts.batchThreads);
+    auto timed = [](LatencyHistogram& h, auto&& op) {
+        auto start = std::chrono::steady_clock::now();
+        op();
+        h.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count()));
+    };
+
+    db.resetLockStats();
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < opts.interactiveThreads; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937_64 rng(t + 1);
+            while (!stop.load(std::memory_order_relaxed)) {
+                long long id = static_cast<long long>(1 + rng() % opts.records);
+                timed(interactive[t], [&] { users.select({ Condition{"id", Op::EQ, id} }); });
+            }
+        });
+    }
+    for (int t = 0; t < opts.batchThreads; ++t) {
+        threads.emplace_back([&, t] {
+            LockPriorityScope scope(prioritize ? LockPriority::BATCH : LockPriority::INTERACTIVE);
+            std::mt19937_64 rng(1000 + t);
+            QueryOptions range;
+            range.limit = opts.scanLength;
+            while (!stop.load(std::memory_order_relaxed)) {
+                long long from = static_cast<long long>(rng() % opts.records);
+                timed(batch[t], [&] { users.select({ Condition{"id", Op::GT, from} }, range); });
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(opts.seconds));
+    stop = true;
+    for (auto& t : threads) t.join();
+
+    PriorityResult r;
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    for (const auto& h : interactive) r.interactive.merge(h);
+    for (const auto& h : batch) r.batch.merge(h);
+    r.lock = db.lockStats();
+    return r;
+}
+
+static void printResult(const char* label, const PriorityResult& r) {
+    const auto& iwait = r.lock.priority(LockPriority::INTERACTIVE);
+    const auto& bwait = r.lock.priority(LockPriority::BATCH);
+    std::cout << std::left << std::setw(10) << label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << r.interactive.count() / r.seconds
+              << std::setw(10) << r.interactive.percentileMicros(0.50)
+              << std::setw(10) << r.interactive.percentileMicros(0.99)
+              << std::setw(11) << r.interactive.percentileMicros(0.999)
+              << std::setw(11) << r.batch.count() / r.seconds
+              << std::setw(12) << r.batch.percentileMicros(0.99)
+              << std::setw(10) << r.lock.maxQueueDepth << "\n"
+              << "          lock wait: interactive " << iwait.waitNanos / 1e6 << " ms over " << iwait.contended
+              << ", batch " << bwait.waitNanos / 1e6 << " ms over " << bwait.contended
+              << ", batch yields " << r.lock.batchYields << "\n";
+    for (const auto& site : r.lock.sites) {
+        std::cout << "          " << std::left << std::setw(24) << site.site << std::right
+                  << std::setw(10) << site.acquisitions << " acq  wait " << std::setw(9) << site.waitNanos / 1e6
+                  << " ms  hold " << std::setw(9) << site.holdNanos / 1e6 << " ms  max hold "
+                  << site.maxHoldNanos / 1e3 << " us\n";
+    }
+    std::cout << std::defaultfloat << std::flush;
+}
+
+int main(int argc, char** argv) {
+    PriorityOptions opts;
+    for (int i = 1; i < argc; ++i) {
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+        const char* arg = argv[i];
+        const char* value = nullptr;
+        if (!std::strcmp(arg, "--records") && (value = next())) opts.records = std::atoll(value);
+        else if (!std::strcmp(arg, "--seconds") && (value = next())) opts.seconds = std::atof(value);
+        else if (!std::strcmp(arg, "--interactive") && (value = next())) opts.interactiveThreads = std::atoi(value);
+        else if (!std::strcmp(arg, "--batch") && (value = next())) opts.batchThreads = std::atoi(value);
+        else if (!std::strcmp(arg, "--scan-length") && (value = next())) opts.scanLength = std::atoi(value);
+        else if (!std::strcmp(arg, "--batch-max-wait") && (value = next())) opts.batchMaxWaitMs = std::atoi(value);
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--records N] [--seconds S] [--interactive N] [--batch N]"
+                      << " [--scan-length N] [--batch-max-wait MS]" << std::endl;
+            return 1;
+        }
+    }
+    if (opts.records <= 0 || opts.interactiveThreads < 1 || opts.batchThreads < 0 || opts.scanLength < 1) {
+        std::cerr << "--records, --interactive and --scan-length must be positive" << std::endl;
+        return 1;
+    }
+
+    Config config;
+    config.batchLockMaxWaitMs = opts.batchMaxWaitMs;
+    Database db(":memory:", config);
+    loadRows(db, opts.records);
+
+    std::cout << opts.interactiveThreads << " interactive point-lookup threads, " << opts.batchThreads
+              << " batch scan threads (" << opts.scanLength << " rows)\n\n"
+              << std::left << std::setw(10) << "mode" << std::right << std::setw(12) << "lookups/s"
+              << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(11) << "p999 us"
+              << std::setw(11) << "scans/s" << std::setw(12) << "scan p99" << std::setw(10) << "max q" << "\n";
+    auto fifo = runMixed(db, opts, false);
+    printResult("fifo", fifo);
+    auto prio = runMixed(db, opts, true);
+    printResult("priority", prio);
+
+    double before = fifo.interactive.percentileMicros(0.99);
+    double after = prio.interactive.percentileMicros(0.99);
+    if (after > 0) {
+        std::cout << "\nInteractive p99: " << std::fixed << std::setprecision(1) << before << " us -> " << after
+                  << " us (" << before / after << "x)" << std::endl;
+    }
+    return 0;
+}
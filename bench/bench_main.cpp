@@ -0,0 +1,16 @@
+#include "bench_harness.h"
+
+// Entry point of the `bench` target. Benchmarks register themselves with SQLDB_BENCHMARK.
+// Usage: bench [--filter substr] [--warmup N] [--repetitions N] [--min-sample-ms N]
+//              [--baseline file] [--save-baseline file] [--threshold 0.10]
+// Exits with 1 when a benchmark's median is slower than the baseline by more than the threshold.
+int main(int argc, char** argv) {
+    bench::Options opts;
+    if (!bench::parseOptions(argc, argv, opts)) return 2;
+    try {
+        return bench::runAll(opts) > 0 ? 1 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark run failed: " << e.what() << std::endl;
+        return 2;
+    }
+}
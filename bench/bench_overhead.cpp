@@ -0,0 +1,252 @@
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "bench_harness.h"
+#include "sqldb/sqldb.h"
+
+using namespace sqldb;
+
+// The same workloads through hand-written sqlite3_prepare_v2/step code and through each
+// sqldb layer. Benchmarks of one operation share the "overhead/<op>/" prefix and the
+// harness reports each layer's median as a multiple of the ".../raw" one.
+// Both sides use identical in-memory tables; raw statements are prepared once per sample,
+// matching sqldb's statement cache, and rows are materialized into a struct.
+
+namespace {
+
+const long long OVERHEAD_ROWS = 10000;
+
+struct OverheadRow {
+    long long id;
+    std::string username;
+    std::string email;
+    int age;
+    double score;
+};
+
+long long overheadKey(size_t i) {
+    return 1 + static_cast<long long>((i * 7919) % OVERHEAD_ROWS);
+}
+
+void rawExec(sqlite3* db, const char* sql) {
+    char* err = nullptr;
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &err) != SQLITE_OK) {
+        std::string msg = err ? err : "unknown error";
+        sqlite3_free(err);
+        throw std::runtime_error(msg);
+    }
+}
+
+// Prepared statement that finalizes itself
+struct RawStmt {
+    sqlite3_stmt* stmt = nullptr;
+    RawStmt(sqlite3* db, const char* sql) {
+        if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+            throw std::runtime_error(sqlite3_errmsg(db));
+        }
+    }
+    ~RawStmt() { sqlite3_finalize(stmt); }
+    operator sqlite3_stmt*() const { return stmt; }
+};
+
+OverheadRow readRaw(sqlite3_stmt* stmt) {
+    OverheadRow r;
+    r.id = sqlite3_column_int64(stmt, 0);
+    r.username = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+    r.email = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+    r.age = sqlite3_column_int(stmt, 3);
+    r.score = sqlite3_column_double(stmt, 4);
+    return r;
+}
+
+struct RawFixture {
+    sqlite3* db = nullptr;
+
+    RawFixture() {
+        sqlite3_open(":memory:", &db);
+        rawExec(db, "CREATE TABLE overhead_users (id INTEGER PRIMARY KEY AUTOINCREMENT, username TEXT, "
+                    "email TEXT, age INTEGER, score REAL);");
+        rawExec(db, "BEGIN;");
+        RawStmt ins(db, "INSERT INTO overhead_users (username, email, age, score) VALUES (?, ?, ?, ?);");
+        for (long long i = 1; i <= OVERHEAD_ROWS; ++i) {
+            std::string name = "user" + std::to_string(i);
+            std::string email = name + "@example.com";
+            sqlite3_bind_text(ins, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(ins, 2, email.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(ins, 3, i % 100);
+            sqlite3_bind_double(ins, 4, (i % 1000) / 10.0);
+            sqlite3_step(ins);
+            sqlite3_reset(ins);
+        }
+        rawExec(db, "COMMIT;");
+    }
+    ~RawFixture() { sqlite3_close(db); }
+};
+
+struct SqldbFixture {
+    Database db{":memory:"};
+    Table* users = nullptr;
+    Table* cached = nullptr; // Same rows, with the getById row cache enabled
+    long long nextId = OVERHEAD_ROWS + 1;
+
+    Table& makeTable(const std::string& name) {
+        auto& t = db.defineTable(name);
+        t.addColumn("id", SQLType::INTEGER, true, true)
+         .addColumn("username", SQLType::TEXT)
+         .addColumn("email", SQLType::TEXT)
+         .addColumn("age", SQLType::INTEGER)
+         .addColumn("score", SQLType::REAL)
+         .create();
+        auto txn = db.transaction();
+        for (long long i = 1; i <= OVERHEAD_ROWS; ++i) {
+            t.insert({ {"username", "user" + std::to_string(i)}, {"email", "user" + std::to_string(i) + "@example.com"},
+                       {"age", i % 100}, {"score", (i % 1000) / 10.0} });
+        }
+        txn.commit();
+        return t;
+    }
+
+    SqldbFixture() {
+        users = &makeTable("overhead_users");
+        cached = &makeTable("overhead_cached");
+        cached->enableRowCache();
+    }
+};
+
+RawFixture& raw() {
+    static RawFixture f;
+    return f;
+}
+
+SqldbFixture& layers() {
+    static SqldbFixture f;
+    return f;
+}
+
+} // namespace
+
+template<>
+struct sqldb::ORM<OverheadRow> {
+    static constexpr const char* table = "overhead_users";
+    static auto map() {
+        return std::make_tuple(
+            orm_field(&OverheadRow::id, "id"),
+            orm_field(&OverheadRow::username, "username"),
+            orm_field(&OverheadRow::email, "email"),
+            orm_field(&OverheadRow::age, "age"),
+            orm_field(&OverheadRow::score, "score")
+        );
+    }
+};
+
+// --- Point lookup by primary key ---
+
+SQLDB_BENCHMARK("overhead/point/raw") {
+    sqlite3* db = raw().db;
+    RawStmt stmt(db, "SELECT id, username, email, age, score FROM overhead_users WHERE id = ?;");
+    for (size_t i = 0; i < iterations; ++i) {
+        sqlite3_bind_int64(stmt, 1, overheadKey(i));
+        std::vector<OverheadRow> rows;
+        while (sqlite3_step(stmt) == SQLITE_ROW) rows.push_back(readRaw(stmt));
+        sqlite3_reset(stmt);
+    }
+}
+
+SQLDB_BENCHMARK("overhead/point/select") {
+    auto& users = *layers().users;
+    for (size_t i = 0; i < iterations; ++i) users.select({ Condition{"id", Op::EQ, overheadKey(i)} });
+}
+
+SQLDB_BENCHMARK("overhead/point/getById") {
+    auto& users = *layers().users;
+    for (size_t i = 0; i < iterations; ++i) users.getById(overheadKey(i));
+}
+
+SQLDB_BENCHMARK("overhead/point/getById_cached") {
+    auto& cached = *layers().cached;
+    for (size_t i = 0; i < iterations; ++i) cached.getById(overheadKey(i));
+}
+
+SQLDB_BENCHMARK("overhead/point/query<T>") {
+    auto& users = *layers().users;
+    for (size_t i = 0; i < iterations; ++i) users.query<OverheadRow>({ Condition{"id", Op::EQ, overheadKey(i)} });
+}
+
+SQLDB_BENCHMARK("overhead/point/queryById<T>") {
+    auto& users = *layers().users;
+    for (size_t i = 0; i < iterations; ++i) users.queryById<OverheadRow>(overheadKey(i));
+}
+
+// --- Range scan of 100 rows ---
+
+SQLDB_BENCHMARK("overhead/range100/raw") {
+    sqlite3* db = raw().db;
+    RawStmt stmt(db, "SELECT id, username, email, age, score FROM overhead_users WHERE id > ? LIMIT 100;");
+    for (size_t i = 0; i < iterations; ++i) {
+        sqlite3_bind_int64(stmt, 1, overheadKey(i) % (OVERHEAD_ROWS - 100));
+        std::vector<OverheadRow> rows;
+        while (sqlite3_step(stmt) == SQLITE_ROW) rows.push_back(readRaw(stmt));
+        sqlite3_reset(stmt);
+    }
+}
+
+SQLDB_BENCHMARK("overhead/range100/select") {
+    auto& users = *layers().users;
+    QueryOptions opts;
+    opts.limit = 100;
+    for (size_t i = 0; i < iterations; ++i) {
+        users.select({ Condition{"id", Op::GT, overheadKey(i) % (OVERHEAD_ROWS - 100)} }, opts);
+    }
+}
+
+SQLDB_BENCHMARK("overhead/range100/query<T>") {
+    auto& users = *layers().users;
+    QueryOptions opts;
+    opts.limit = 100;
+    for (size_t i = 0; i < iterations; ++i) {
+        users.query<OverheadRow>({ Condition{"id", Op::GT, overheadKey(i) % (OVERHEAD_ROWS - 100)} }, opts);
+    }
+}
+
+SQLDB_BENCHMARK("overhead/range100/selectColumnar") {
+    auto& users = *layers().users;
+    QueryOptions opts;
+    opts.limit = 100;
+    for (size_t i = 0; i < iterations; ++i) {
+        users.selectColumnar({ Condition{"id", Op::GT, overheadKey(i) % (OVERHEAD_ROWS - 100)} }, opts);
+    }
+}
+
+// --- Single-row autocommit insert (rows removed again at the end of each sample) ---
+
+SQLDB_BENCHMARK("overhead/insert/raw") {
+    sqlite3* db = raw().db;
+    {
+        RawStmt stmt(db, "INSERT INTO overhead_users (username, email, age, score) VALUES (?, ?, ?, ?);");
+        for (size_t i = 0; i < iterations; ++i) {
+            sqlite3_bind_text(stmt, 1, "new", -1, SQLITE_STATIC);
+            sqlite3_bind_text(stmt, 2, "new@example.com", -1, SQLITE_STATIC);
+            sqlite3_bind_int64(stmt, 3, 30);
+            sqlite3_bind_double(stmt, 4, 50.0);
+            sqlite3_step(stmt);
+            sqlite3_reset(stmt);
+        }
+    }
+    rawExec(db, ("DELETE FROM overhead_users WHERE id > " + std::to_string(OVERHEAD_ROWS) + ";").c_str());
+}
+
+SQLDB_BENCHMARK("overhead/insert/row") {
+    auto& users = *layers().users;
+    for (size_t i = 0; i < iterations; ++i) {
+        users.insert({ {"username", "new"}, {"email", "new@example.com"}, {"age", 30}, {"score", 50.0} });
+    }
+    users.remove({ Condition{"id", Op::GT, OVERHEAD_ROWS} });
+}
+
+SQLDB_BENCHMARK("overhead/insert/struct") {
+    auto& f = layers();
+    for (size_t i = 0; i < iterations; ++i) {
+        f.users->insert(OverheadRow{ f.nextId++, "new", "new@example.com", 30, 50.0 });
+    }
+    f.users->remove({ Condition{"id", Op::GT, OVERHEAD_ROWS} });
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <cmath>
+#include <random>
+
+// Key distributions for benchmarks and the load generator.
+
+// Zipfian key generator over [0, n), as in YCSB (Gray et al.): item 0 is the hottest.
+// theta = 0.99 is YCSB's default skew.
+class ZipfianGenerator {
+    uint64_t n;
+    double theta, alpha, zetan, eta;
+    std::uniform_real_distribution<double> uniform{0.0, 1.0};
+
+    static double zeta(uint64_t count, double theta) {
+        double sum = 0.0;
+        for (uint64_t i = 1; i <= count; ++i) sum += 1.0 / std::pow(static_cast<double>(i), theta);
+        return sum;
+    }
+public:
+    ZipfianGenerator(uint64_t items, double skew = 0.99) : n(items), theta(skew) {
+        alpha = 1.0 / (1.0 - theta);
+        zetan = zeta(n, theta);
+        eta = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta(2, theta) / zetan);
+    }
+
+    template<typename Rng>
+    uint64_t next(Rng& rng) {
+        double u = uniform(rng);
+        double uz = u * zetan;
+        if (uz < 1.0) return 0;
+        if (uz < 1.0 + std::pow(0.5, theta)) return 1;
+        return static_cast<uint64_t>(n * std::pow(eta * u - eta + 1.0, alpha)) % n;
+    }
+};
+
+// YCSB "latest": Zipfian over recency, so the most recently inserted keys are the
+// hottest. Keys are 1-based and 'newest' is the highest key inserted so far.
+class LatestGenerator {
+    ZipfianGenerator zipf;
+public:
+    explicit LatestGenerator(uint64_t items, double skew = 0.99) : zipf(items, skew) {}
+
+    template<typename Rng>
+    uint64_t next(Rng& rng, uint64_t newest) {
+        uint64_t back = zipf.next(rng);
+        return back < newest ? newest - back : 1;
+    }
+};
@@ -0,0 +1,303 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <array>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "sqldb/sqldb.h"
+#include "key_generators.h"
+
+using namespace sqldb;
+
+// YCSB-style load generator: N threads share one Database and run a read / update /
+// insert / scan mix over a bench_users table, for each thread count in turn. Reports
+// throughput, per-operation latency percentiles (sqldb::LatencyHistogram, optionally
+// dumped in full), and the time threads spent waiting for the connection lock
+// (Database::lockStats).
+//
+// Usage: loadgen [--workload a|b|c|d|e] [--read P] [--update P] [--insert P] [--scan P]
+//                [--distribution uniform|zipfian|latest] [--records N] [--seconds S]
+//                [--threads 1,2,4,...] [--scan-length N] [--db file] [--histogram]
+//
+// Workloads follow the YCSB core set: a = 50/50 read/update, b = 95/5 read/update,
+// c = read only, d = 95/5 read/insert on the latest keys, e = 95/5 scan/insert.
+// Explicit --read/--update/--insert/--scan proportions override the workload's mix.
+
+enum OpKind { READ, UPDATE, INSERT, SCAN, OP_KINDS };
+static const char* const OP_NAMES[OP_KINDS] = {"READ", "UPDATE", "INSERT", "SCAN"};
+
+enum class Distribution { UNIFORM, ZIPFIAN, LATEST };
+
+struct LoadOptions {
+    std::array<double, OP_KINDS> mix{0.5, 0.5, 0.0, 0.0};
+    Distribution distribution = Distribution::ZIPFIAN;
+    uint64_t records = 100000;
+    double seconds = 5.0;
+    std::vector<int> threads{1, 2, 4, 8, 16, 32, 64};
+    int scanLength = 100;
+    std::string dbFile = "loadgen.db";
+    bool histogram = false;
+};
+
+// Bucket-by-bucket dump of a histogram with cumulative percentages
+static void printHistogram(std::ostream& out, const LatencyHistogram& h) {
+    uint64_t seen = 0;
+    for (int i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+        uint64_t n = h.bucketCount(i);
+        if (!n) continue;
+        seen += n;
+        out << "      < " << std::setw(11) << LatencyHistogram::bucketLowerNanos(i + 1) / 1000.0 << " us  "
+            << std::setw(10) << n << "  " << std::setw(7) << 100.0 * seen / h.count() << "%\n";
+    }
+}
+
+struct ThreadResult {
+    std::array<LatencyHistogram, OP_KINDS> latency;
+    uint64_t errors = 0;
+};
+
+struct RunResult {
+    int threads = 0;
+    double seconds = 0.0;
+    uint64_t ops = 0;
+    uint64_t errors = 0;
+    std::array<LatencyHistogram, OP_KINDS> latency;
+    LockStats lock;
+
+    double throughput() const { return seconds > 0 ? ops / seconds : 0.0; }
+};
+
+static uint64_t fnvScramble(uint64_t v) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < 8; ++i) {
+        h ^= (v >> (i * 8)) & 0xff;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static void updateNewest(std::atomic<uint64_t>& newest, uint64_t key) {
+    uint64_t cur = newest.load(std::memory_order_relaxed);
+    while (key > cur && !newest.compare_exchange_weak(cur, key, std::memory_order_relaxed)) {}
+}
+
+static void worker(int index, const LoadOptions& opts, Table& users, std::atomic<bool>& running,
+                   std::atomic<uint64_t>& newest, ThreadResult& out) {
+    std::mt19937_64 rng(0x9e3779b97f4a7c15ULL * (index + 1));
+    std::uniform_real_distribution<double> pick(0.0, 1.0);
+    ZipfianGenerator zipf(opts.records);
+    LatestGenerator latest(opts.records);
+    std::array<double, OP_KINDS> cumulative{};
+    double sum = 0.0;
+    for (int k = 0; k < OP_KINDS; ++k) cumulative[k] = (sum += opts.mix[k]);
+
+    auto nextKey = [&]() -> long long {
+        uint64_t n = newest.load(std::memory_order_relaxed);
+        switch (opts.distribution) {
+            case Distribution::UNIFORM: return 1 + static_cast<long long>(rng() % n);
+            // Scrambled so the hot keys are spread over the table, as in YCSB
+            case Distribution::ZIPFIAN: return 1 + static_cast<long long>(fnvScramble(zipf.next(rng)) % opts.records);
+            case Distribution::LATEST: return static_cast<long long>(latest.next(rng, n));
+        }
+        return 1;
+    };
+
+    QueryOptions scan;
+    scan.limit = opts.scanLength;
+    while (running.load(std::memory_order_relaxed)) {
+        double r = pick(rng) * sum;
+        int kind = 0;
+        while (kind < OP_KINDS - 1 && r >= cumulative[kind]) ++kind;
+
+        auto start = std::chrono::steady_clock::now();
+        try {
+            switch (kind) {
+                case READ:
+                    users.getById(nextKey());
+                    break;
+                case UPDATE:
+                    users.update({ {"score", static_cast<double>(rng() % 1000) / 10.0} },
+                                 { Condition{"id", Op::EQ, nextKey()} });
+                    break;
+                case INSERT: {
+                    long long id = users.insert({ {"username", "load" + std::to_string(rng())},
+                                                  {"email", "load@example.com"}, {"age", static_cast<long long>(rng() % 100)},
+                                                  {"score", 0.0} });
+                    updateNewest(newest, static_cast<uint64_t>(id));
+                    break;
+                }
+                case SCAN:
+                    users.select({ Condition{"id", Op::GT, nextKey()} }, scan);
+                    break;
+            }
+        } catch (const std::exception&) {
+            ++out.errors;
+            continue;
+        }
+        out.latency[kind].record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count()));
+    }
+}
+
+static RunResult runThreads(Database& db, Table& users, const LoadOptions& opts, int threads,
+                            std::atomic<uint64_t>& newest) {
+    std::vector<ThreadResult> perThread(threads);
+    std::atomic<bool> running{true};
+    db.resetLockStats();
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back(worker, t, std::cref(opts), std::ref(users), std::ref(running),
+                          std::ref(newest), std::ref(perThread[t]));
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(opts.seconds));
+    running = false;
+    for (auto& th : pool) th.join();
+
+    RunResult result;
+    result.threads = threads;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    result.lock = db.lockStats();
+    for (const auto& tr : perThread) {
+        for (int k = 0; k < OP_KINDS; ++k) result.latency[k].merge(tr.latency[k]);
+        result.errors += tr.errors;
+    }
+    for (const auto& h : result.latency) result.ops += h.count();
+    return result;
+}
+
+static void printRun(const RunResult& r, bool histogram) {
+    double waitSeconds = r.lock.waitNanos / 1e9;
+    std::cout << "\nthreads=" << r.threads << " ops=" << r.ops << " errors=" << r.errors << std::fixed
+              << std::setprecision(0) << " throughput=" << r.throughput() << " ops/s\n"
+              << std::setprecision(1) << "  lock: " << (r.lock.acquisitions ? 100.0 * r.lock.contended / r.lock.acquisitions : 0.0)
+              << "% of acquisitions waited, " << std::setprecision(3) << waitSeconds << " s total wait ("
+              << std::setprecision(1) << 100.0 * waitSeconds / (r.threads * r.seconds) << "% of thread time), max "
+              << r.lock.maxWaitNanos / 1e6 << " ms\n"
+              << "  " << std::left << std::setw(8) << "op" << std::right << std::setw(10) << "count"
+              << std::setw(10) << "mean us" << std::setw(10) << "p50" << std::setw(10) << "p95"
+              << std::setw(10) << "p99" << std::setw(10) << "p999" << std::setw(12) << "max" << "\n";
+    for (int k = 0; k < OP_KINDS; ++k) {
+        const auto& h = r.latency[k];
+        if (!h.count()) continue;
+        std::cout << "  " << std::left << std::setw(8) << OP_NAMES[k] << std::right << std::setw(10) << h.count()
+                  << std::setprecision(1) << std::setw(10) << h.meanMicros()
+                  << std::setw(10) << h.percentileMicros(0.50) << std::setw(10) << h.percentileMicros(0.95)
+                  << std::setw(10) << h.percentileMicros(0.99) << std::setw(10) << h.percentileMicros(0.999)
+                  << std::setw(12) << h.maxMicros() << "\n";
+        if (histogram) printHistogram(std::cout, h);
+    }
+    std::cout << std::defaultfloat << std::flush;
+}
+
+static bool parseArgs(int argc, char** argv, LoadOptions& opts) {
+    bool mixGiven = false;
+    std::array<double, OP_KINDS> mix{};
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        auto take = [&] { ++i; return std::string(value); };
+        if (arg == "--histogram") { opts.histogram = true; continue; }
+        if (!value) return false;
+        if (arg == "--workload") {
+            std::string w = take();
+            if (w == "a") { opts.mix = {0.5, 0.5, 0.0, 0.0}; opts.distribution = Distribution::ZIPFIAN; }
+            else if (w == "b") { opts.mix = {0.95, 0.05, 0.0, 0.0}; opts.distribution = Distribution::ZIPFIAN; }
+            else if (w == "c") { opts.mix = {1.0, 0.0, 0.0, 0.0}; opts.distribution = Distribution::ZIPFIAN; }
+            else if (w == "d") { opts.mix = {0.95, 0.0, 0.05, 0.0}; opts.distribution = Distribution::LATEST; }
+            else if (w == "e") { opts.mix = {0.0, 0.0, 0.05, 0.95}; opts.distribution = Distribution::ZIPFIAN; }
+            else return false;
+        }
+        else if (arg == "--read") { mix[READ] = std::atof(take().c_str()); mixGiven = true; }
+        else if (arg == "--update") { mix[UPDATE] = std::atof(take().c_str()); mixGiven = true; }
+        else if (arg == "--insert") { mix[INSERT] = std::atof(take().c_str()); mixGiven = true; }
+        else if (arg == "--scan") { mix[SCAN] = std::atof(take().c_str()); mixGiven = true; }
+        else if (arg == "--distribution") {
+            std::string d = take();
+            if (d == "uniform") opts.distribution = Distribution::UNIFORM;
+            else if (d == "zipfian") opts.distribution = Distribution::ZIPFIAN;
+            else if (d == "latest") opts.distribution = Distribution::LATEST;
+            else return false;
+        }
+        else if (arg == "--records") opts.records = std::strtoull(take().c_str(), nullptr, 10);
+        else if (arg == "--seconds") opts.seconds = std::atof(take().c_str());
+        else if (arg == "--scan-length") opts.scanLength = std::atoi(take().c_str());
+        else if (arg == "--db") opts.dbFile = take();
+        else if (arg == "--threads") {
+            opts.threads.clear();
+            std::string list = take();
+            for (size_t pos = 0; pos < list.size();) {
+                size_t comma = list.find(',', pos);
+                if (comma == std::string::npos) comma = list.size();
+                int n = std::atoi(list.substr(pos, comma - pos).c_str());
+                if (n < 1 || n > 64) return false;
+                opts.threads.push_back(n);
+                pos = comma + 1;
+            }
+        }
+        else return false;
+    }
+    if (mixGiven) opts.mix = mix;
+    double total = 0.0;
+    for (double p : opts.mix) total += p;
+    return total > 0.0 && opts.records > 1 && !opts.threads.empty() && opts.seconds > 0;
+}
+
+int main(int argc, char** argv) {
+    LoadOptions opts;
+    if (!parseArgs(argc, argv, opts)) {
+        std::cerr << "Usage: " << argv[0] << " [--workload a|b|c|d|e] [--read P] [--update P] [--insert P] [--scan P]\n"
+                  << "       [--distribution uniform|zipfian|latest] [--records N] [--seconds S]\n"
+                  << "       [--threads 1,2,4,...(max 64)] [--scan-length N] [--db file] [--histogram]" << std::endl;
+        return 1;
+    }
+
+    for (const char* suffix : {"", "-wal", "-shm"}) std::remove((opts.dbFile + suffix).c_str());
+    Config cfg;
+    cfg.busyTimeoutMs = 5000;
+    Database db(opts.dbFile, cfg);
+    auto& users = db.defineTable("bench_users");
+    users.addColumn("id", SQLType::INTEGER, true, true)
+         .addColumn("username", SQLType::TEXT)
+         .addColumn("email", SQLType::TEXT)
+         .addColumn("age", SQLType::INTEGER)
+         .addColumn("score", SQLType::REAL)
+         .create();
+
+    std::cout << "Loading " << opts.records << " records..." << std::endl;
+    {
+        auto txn = db.transaction();
+        for (uint64_t i = 1; i <= opts.records; ++i) {
+            users.insert({ {"username", "user" + std::to_string(i)}, {"email", "user" + std::to_string(i) + "@example.com"},
+                           {"age", static_cast<long long>(i % 100)}, {"score", (i % 1000) / 10.0} });
+        }
+        txn.commit();
+    }
+    std::atomic<uint64_t> newest{opts.records};
+
+    std::vector<RunResult> runs;
+    for (int threads : opts.threads) {
+        runs.push_back(runThreads(db, users, opts, threads, newest));
+        printRun(runs.back(), opts.histogram);
+    }
+
+    std::cout << "\nScaling\n" << std::setw(8) << "threads" << std::setw(14) << "ops/s"
+              << std::setw(10) << "speedup" << std::setw(14) << "lock wait %" << "\n" << std::fixed;
+    for (const auto& r : runs) {
+        double waitShare = 100.0 * r.lock.waitNanos / 1e9 / (r.threads * r.seconds);
+        std::cout << std::setw(8) << r.threads << std::setprecision(0) << std::setw(14) << r.throughput()
+                  << std::setprecision(2) << std::setw(10) << r.throughput() / runs.front().throughput()
+                  << std::setprecision(1) << std::setw(14) << waitShare << "\n";
+    }
+    std::cout << std::defaultfloat << std::flush;
+
+    for (const char* suffix : {"", "-wal", "-shm"}) std::remove((opts.dbFile + suffix).c_str());
+    return 0;
+}
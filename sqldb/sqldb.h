@@ -11,8 +11,42 @@
 #include <mutex>
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <list>
 #include <tuple> // Added for ORM mappings
+#include <algorithm>
+#include <functional>
+#include <charconv>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <condition_variable>
+#include <exception>
+#include <atomic>
+#include <array>
+#include <iomanip>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SQLDB_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SQLDB_SIMD_SSE2 1
+#if defined(__SSE4_2__) || defined(__AVX__)
+#include <nmmintrin.h>
+#define SQLDB_SIMD_SSE42 1
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 namespace sqldb {
 
@@ -38,10 +72,354 @@ enum class SyncMode {
     EXTRA
 };
 
+enum class TempStore {
+    DEFAULT, // Compile-time default (normally files)
+    FILE,
+    MEMORY
+};
+
+enum class AutoVacuum {
+    NONE,
+    FULL,        // Truncate free pages at every commit
+    INCREMENTAL  // Keep free pages until Database::incrementalVacuum()
+};
+
 struct Config {
     bool enableForeignKeys = true;
     bool enableWAL = true;
     SyncMode synchronous = SyncMode::NORMAL;
+
+    // Storage tuning. Zero/negative values and DEFAULT/NONE keep SQLite's defaults.
+    long long mmapSize = -1;     // PRAGMA mmap_size in bytes (0 = no memory-mapped I/O)
+    int cacheSizeKiB = 0;        // PRAGMA cache_size per connection (SQLite default ~2 MiB)
+    int pageSize = 0;            // PRAGMA page_size. Only applies to a database with no tables yet
+    TempStore tempStore = TempStore::DEFAULT; // Temp tables, indexes and sorts
+    int walAutocheckpoint = -1;  // WAL pages before a commit checkpoints (0 = never)
+    int busyTimeoutMs = 0;       // Wait this long on a locked database instead of failing
+    AutoVacuum autoVacuum = AutoVacuum::NONE; // Like pageSize, fixed once the first table exists
+
+    bool enableMetrics = false;  // Record operation latencies from the start (Database::enableMetrics)
+    int batchLockMaxWaitMs = 100; // Longest a LockPriority::BATCH call waits behind interactive ones
+    int queryTimeoutMs = 0;       // Default time budget of Table reads (QueryOptions::timeout); 0 = none
+
+    // Large page cache and memory-mapped reads; for lookup- and scan-dominated workloads
+    static Config ReadHeavy() {
+        Config c;
+        c.mmapSize = 256LL << 20;
+        c.cacheSizeKiB = 64 << 10;
+        c.tempStore = TempStore::MEMORY;
+        return c;
+    }
+
+    // Fewer, larger checkpoints and a busy timeout for concurrent writers
+    static Config WriteHeavy() {
+        Config c;
+        c.cacheSizeKiB = 32 << 10;
+        c.tempStore = TempStore::MEMORY;
+        c.walAutocheckpoint = 10000;
+        c.busyTimeoutMs = 5000;
+        return c;
+    }
+
+    // Small cache, no mapping, temp data on disk, free pages returned to the file system
+    static Config LowMemory() {
+        Config c;
+        c.mmapSize = 0;
+        c.cacheSizeKiB = 512;
+        c.tempStore = TempStore::FILE;
+        c.walAutocheckpoint = 250;
+        c.autoVacuum = AutoVacuum::INCREMENTAL;
+        return c;
+    }
+
+    // One-off loads that can be redone from the source after a crash: no fsync,
+    // a large cache and larger pages
+    static Config BulkLoad() {
+        Config c;
+        c.synchronous = SyncMode::OFF;
+        c.cacheSizeKiB = 256 << 10;
+        c.pageSize = 16384;
+        c.tempStore = TempStore::MEMORY;
+        c.walAutocheckpoint = 10000;
+        return c;
+    }
+};
+
+// Settings for Database::bulkLoad
+struct BulkLoadOptions {
+    size_t batchSize = 100000;   // Rows per transaction
+    int cacheSizeKiB = 1 << 20;  // PRAGMA cache_size for the load (1 GiB)
+    bool disableJournal = false; // journal_mode = OFF. Fastest, but a crash mid-batch can corrupt the file
+    // Required with disableJournal: without a journal a failed batch can't be rolled back,
+    // so some of its rows may stay in the table
+    bool acceptPartialBatch = false;
+};
+
+// Settings for Database::importCsv
+struct CsvOptions {
+    char delimiter = ',';               // '\t' for TSV
+    bool header = true;                 // First record names the columns
+    std::vector<std::string> columns;   // Target columns when there is no header (default: table column order)
+    unsigned threads = 0;               // Parser threads (0 = hardware concurrency)
+    size_t chunkBytes = 4 << 20;        // Bytes handed to a parser thread at a time
+    size_t batchRows = 100000;          // Rows per transaction
+    size_t rowsPerStatement = 256;      // Rows per multi-row INSERT
+};
+
+struct ImportStats {
+    size_t rows = 0;
+    size_t bytes = 0;
+    double seconds = 0.0;
+
+    double rowsPerSecond() const { return seconds > 0 ? rows / seconds : 0.0; }
+    double mbPerSecond() const { return seconds > 0 ? bytes / (1024.0 * 1024.0) / seconds : 0.0; }
+};
+
+// Background WAL checkpointing (Database::startCheckpointer)
+enum class CheckpointMode {
+    PASSIVE = SQLITE_CHECKPOINT_PASSIVE,   // Copy what it can without waiting for anyone
+    FULL = SQLITE_CHECKPOINT_FULL,         // Wait for writers, then copy everything
+    RESTART = SQLITE_CHECKPOINT_RESTART,   // FULL, then wait for readers so the next write starts the WAL over
+    TRUNCATE = SQLITE_CHECKPOINT_TRUNCATE  // RESTART, then truncate the WAL file to zero bytes
+};
+
+struct CheckpointOptions {
+    std::chrono::milliseconds interval{1000};      // Time between PASSIVE checkpoints
+    int64_t walBudgetBytes = 64 << 20;             // Escalate once the WAL log (frames since its last restart) is longer
+    CheckpointMode escalation = CheckpointMode::TRUNCATE;
+    std::chrono::milliseconds busyTimeout{2000};   // How long an escalated checkpoint waits for readers/writers
+};
+
+struct CheckpointStats {
+    uint64_t checkpoints = 0;       // All attempts
+    uint64_t escalations = 0;       // RESTART/TRUNCATE runs
+    uint64_t busy = 0;              // Attempts that could not complete (readers or writers in the way)
+    uint64_t framesBackfilled = 0;  // WAL frames copied into the database file, summed over checkpoints
+    int64_t walBytes = 0;           // WAL file size after the last checkpoint
+    int64_t walFrames = 0;          // Frames in the WAL after the last checkpoint
+    double lastMillis = 0.0;        // Duration of the last checkpoint
+    double maxMillis = 0.0;
+    double totalMillis = 0.0;
+};
+
+// Reads stopped by a time budget or cancellation (Database::cancellationStats)
+struct CancellationStats {
+    uint64_t timeouts = 0;
+    uint64_t cancellations = 0;  // Cancellation tokens and Database::interrupt
+    uint64_t lostNanos = 0;      // Connection time spent in the stopped reads
+    uint64_t maxLostNanos = 0;
+};
+
+// Connection lock contention (Database::lockStats)
+//
+// Waiting threads are served interactive first, FIFO within a class. Code running
+// bulk work marks itself with LockPriorityScope(LockPriority::BATCH).
+enum class LockPriority { INTERACTIVE, BATCH };
+
+struct LockCounters {
+    uint64_t acquisitions = 0;  // Every lock of the connection mutex
+    uint64_t contended = 0;     // Acquisitions that had to wait for another thread
+    uint64_t waitNanos = 0;     // Time spent waiting, summed over contended acquisitions
+    uint64_t maxWaitNanos = 0;
+    uint64_t holdNanos = 0;     // Time between acquisition and release
+    uint64_t maxHoldNanos = 0;
+};
+
+struct LockSiteStats : LockCounters {
+    std::string site;           // e.g. "Table::select"
+};
+
+struct LockStats : LockCounters {
+    size_t queueDepth = 0;        // Threads waiting right now
+    size_t maxQueueDepth = 0;
+    double meanQueueDepth = 0.0;  // Threads already waiting, averaged over contended acquisitions
+    uint64_t batchYields = 0;     // Batch waiters served ahead of interactive ones to avoid starvation
+    std::array<LockCounters, 2> byPriority; // Indexed by LockPriority
+    std::vector<LockSiteStats> sites;       // Longest total wait first
+
+    const LockCounters& priority(LockPriority p) const { return byPriority[static_cast<size_t>(p)]; }
+};
+
+// Priority of the calling thread's connection lock requests
+inline LockPriority& currentLockPriority() {
+    thread_local LockPriority priority = LockPriority::INTERACTIVE;
+    return priority;
+}
+
+// Sets the calling thread's lock priority until the end of the scope
+class LockPriorityScope {
+    LockPriority saved;
+
+public:
+    explicit LockPriorityScope(LockPriority priority) : saved(currentLockPriority()) {
+        currentLockPriority() = priority;
+    }
+    ~LockPriorityScope() { currentLockPriority() = saved; }
+    LockPriorityScope(const LockPriorityScope&) = delete;
+    LockPriorityScope& operator=(const LockPriorityScope&) = delete;
+};
+
+// Operation metrics (Database::enableMetrics)
+enum class MetricOp { INSERT, SELECT, UPDATE, REMOVE, COMMIT };
+enum class MetricPhase {
+    TOTAL,       // Whole call
+    LOCK_WAIT,   // Acquiring the connection lock
+    BUILD,       // Building the SQL text and bindings
+    PREPARE,     // Statement cache lookup / sqlite3_prepare_v2
+    STEP,        // sqlite3_step (binding included)
+    MATERIALIZE  // Converting result rows into Row maps
+};
+constexpr size_t METRIC_OPS = 5;
+constexpr size_t METRIC_PHASES = 6;
+
+inline const char* metricOpName(MetricOp op) {
+    static const char* const names[METRIC_OPS] = {"insert", "select", "update", "remove", "commit"};
+    return names[static_cast<size_t>(op)];
+}
+
+inline const char* metricPhaseName(MetricPhase phase) {
+    static const char* const names[METRIC_PHASES] = {"total", "lock_wait", "build", "prepare", "step", "materialize"};
+    return names[static_cast<size_t>(phase)];
+}
+
+// HDR-style latency histogram over nanoseconds: exact below 32 ns, then 16 linear
+// sub-buckets per power of two (values within ~6% of their bucket edge) up to 2^40 ns
+// (~18 minutes); larger values land in the last bucket. Not thread-safe.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 4;
+    static constexpr int SUB = 1 << SUB_BITS;
+    static constexpr int MAX_BITS = 40;
+    static constexpr int BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB;
+
+    static int bucketOf(uint64_t nanos) {
+        if (nanos >= (uint64_t(1) << MAX_BITS)) nanos = (uint64_t(1) << MAX_BITS) - 1;
+        if (nanos < 2 * SUB) return static_cast<int>(nanos);
+#if defined(_MSC_VER)
+        unsigned long msbIndex;
+        _BitScanReverse64(&msbIndex, nanos);
+        int msb = static_cast<int>(msbIndex);
+#else
+        int msb = 63 - __builtin_clzll(nanos);
+#endif
+        int shift = msb - SUB_BITS;
+        return (shift + 1) * SUB + static_cast<int>((nanos >> shift) - SUB);
+    }
+
+    // Smallest value of bucket 'idx'; bucketLowerNanos(idx + 1) is its exclusive upper edge
+    static uint64_t bucketLowerNanos(int idx) {
+        if (idx < 2 * SUB) return static_cast<uint64_t>(idx);
+        int shift = idx / SUB - 1;
+        return static_cast<uint64_t>(idx % SUB + SUB) << shift;
+    }
+
+    void record(uint64_t nanos) { add(bucketOf(nanos), 1, nanos, nanos); }
+
+    // Adds 'n' values to bucket 'idx' with the given sum and maximum (merging recorders)
+    void add(int idx, uint64_t n, uint64_t sum, uint64_t max) {
+        if (!n) return;
+        counts[idx] += n;
+        total += n;
+        sumNanos_ += sum;
+        maxNanos_ = std::max(maxNanos_, max);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < BUCKETS; ++i) counts[i] += other.counts[i];
+        total += other.total;
+        sumNanos_ += other.sumNanos_;
+        maxNanos_ = std::max(maxNanos_, other.maxNanos_);
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t bucketCount(int idx) const { return counts[idx]; }
+    uint64_t sumNanos() const { return sumNanos_; }
+    uint64_t maxNanos() const { return maxNanos_; }
+    double meanMicros() const { return total ? sumNanos_ / 1000.0 / total : 0.0; }
+    double maxMicros() const { return maxNanos_ / 1000.0; }
+
+    // Upper edge of the bucket holding the q-quantile (q in [0, 1]), capped at the maximum
+    double percentileMicros(double q) const {
+        if (!total) return 0.0;
+        uint64_t rank = static_cast<uint64_t>(q * (total - 1)) + 1, seen = 0;
+        for (int i = 0; i < BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= rank) return std::min(bucketLowerNanos(i + 1), maxNanos_) / 1000.0;
+        }
+        return maxMicros();
+    }
+
+private:
+    std::vector<uint64_t> counts = std::vector<uint64_t>(BUCKETS, 0);
+    uint64_t total = 0, sumNanos_ = 0, maxNanos_ = 0;
+};
+
+// Merged view of every thread's recordings (Database::metricsSnapshot)
+struct MetricsSnapshot {
+    std::array<std::array<LatencyHistogram, METRIC_PHASES>, METRIC_OPS> histograms;
+
+    const LatencyHistogram& get(MetricOp op, MetricPhase phase = MetricPhase::TOTAL) const {
+        return histograms[static_cast<size_t>(op)][static_cast<size_t>(phase)];
+    }
+
+    // Prometheus text exposition: one cumulative histogram per recorded op/phase pair
+    // (sqldb_op_duration_seconds{op=,phase=,le=}), plus p50/p99/p999 gauges.
+    std::string text() const {
+        static const double bounds[] = {1e-6, 2.5e-6, 5e-6, 1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 5e-4, 1e-3,
+                                        2.5e-3, 5e-3, 1e-2, 2.5e-2, 5e-2, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0};
+        std::ostringstream out;
+        out << std::setprecision(9);
+        out << "# HELP sqldb_op_duration_seconds Duration of sqldb operations by phase.\n"
+            << "# TYPE sqldb_op_duration_seconds histogram\n";
+        for (size_t o = 0; o < METRIC_OPS; ++o) {
+            for (size_t p = 0; p < METRIC_PHASES; ++p) {
+                const auto& h = histograms[o][p];
+                if (!h.count()) continue;
+                std::string labels = std::string("op=\"") + metricOpName(static_cast<MetricOp>(o)) +
+                                     "\",phase=\"" + metricPhaseName(static_cast<MetricPhase>(p)) + "\"";
+                // A fine bucket counts towards 'le' once its whole range is <= le
+                uint64_t cumulative = 0;
+                int idx = 0;
+                for (double le : bounds) {
+                    uint64_t limit = static_cast<uint64_t>(le * 1e9);
+                    while (idx < LatencyHistogram::BUCKETS && LatencyHistogram::bucketLowerNanos(idx + 1) <= limit + 1) {
+                        cumulative += h.bucketCount(idx++);
+                    }
+                    out << "sqldb_op_duration_seconds_bucket{" << labels << ",le=\"" << le << "\"} " << cumulative << "\n";
+                }
+                out << "sqldb_op_duration_seconds_bucket{" << labels << ",le=\"+Inf\"} " << h.count() << "\n"
+                    << "sqldb_op_duration_seconds_sum{" << labels << "} " << h.sumNanos() / 1e9 << "\n"
+                    << "sqldb_op_duration_seconds_count{" << labels << "} " << h.count() << "\n";
+            }
+        }
+        out << "# HELP sqldb_op_duration_quantile_seconds Latency quantiles of sqldb operations by phase.\n"
+            << "# TYPE sqldb_op_duration_quantile_seconds gauge\n";
+        for (size_t o = 0; o < METRIC_OPS; ++o) {
+            for (size_t p = 0; p < METRIC_PHASES; ++p) {
+                const auto& h = histograms[o][p];
+                if (!h.count()) continue;
+                for (double q : {0.5, 0.99, 0.999}) {
+                    out << "sqldb_op_duration_quantile_seconds{op=\"" << metricOpName(static_cast<MetricOp>(o))
+                        << "\",phase=\"" << metricPhaseName(static_cast<MetricPhase>(p)) << "\",quantile=\"" << q
+                        << "\"} " << h.percentileMicros(q) / 1e6 << "\n";
+                }
+            }
+        }
+        return out.str();
+    }
+};
+
+// Serialized database file (Database::serialize / Database::fromImage)
+using DatabaseImage = std::shared_ptr<const std::vector<unsigned char>>;
+
+// Online backup (Database::backupTo)
+using BackupProgress = std::function<void(int remainingPages, int totalPages)>;
+
+struct BackupStats {
+    int pages = 0;      // Pages in the finished copy
+    int steps = 0;      // sqlite3_backup_step calls
+    int restarts = 0;   // Times the copy started over because another connection wrote the source
+    double seconds = 0.0;
 };
 
 inline std::string quoteIdentifier(const std::string& id) {
@@ -138,6 +516,14 @@ struct ColumnDef {
     bool onDeleteCascade = false;
 };
 
+// A foreign key whose child columns are not the leading columns of any index.
+// Deleting (or updating the key of) a parent row then scans the whole child table.
+struct UnindexedForeignKey {
+    std::string table;
+    std::vector<std::string> columns;
+    std::string refTable;
+};
+
 // Join Types
 enum class JoinType {
     INNER,
@@ -162,6 +548,28 @@ struct JoinClause {
     }
 };
 
+// Lets another thread stop reads that were given this token (QueryOptions::cancel).
+// Once cancelled it stays cancelled; use a fresh token for the next request.
+class CancellationToken {
+    std::atomic<bool> flag{false};
+
+public:
+    void cancel() { flag.store(true, std::memory_order_relaxed); }
+    bool cancelled() const { return flag.load(std::memory_order_relaxed); }
+};
+
+// Thrown by a read stopped through its CancellationToken or Database::interrupt
+class QueryCancelled : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Thrown by a read that ran past its time budget (QueryOptions::timeout)
+class QueryTimeout : public QueryCancelled {
+public:
+    using QueryCancelled::QueryCancelled;
+};
+
 struct QueryOptions {
     std::vector<std::string> columns; // Empty or {"*"} implies all.
     std::vector<JoinClause> joins;
@@ -171,148 +579,1526 @@ struct QueryOptions {
     bool orderDesc = false;
     int limit = -1;
     int offset = -1;
+
+    // Serve from / store in the Database result cache (Database::enableResultCache)
+    bool cache = false;
+    std::chrono::milliseconds cacheTtl{0}; // 0 = the cache's default TTL
+
+    // Limits on running the query once it holds the connection (QueryTimeout / QueryCancelled)
+    std::chrono::milliseconds timeout{0}; // 0 = Config::queryTimeoutMs, negative = no limit
+    std::shared_ptr<CancellationToken> cancel;
+};
+
+// Aggregate functions for Table::aggregateBy
+enum class Aggregate { COUNT, SUM, AVG, MIN, MAX };
+
+inline std::string aggregateToString(Aggregate agg) {
+    switch (agg) {
+        case Aggregate::COUNT: return "COUNT";
+        case Aggregate::SUM:   return "SUM";
+        case Aggregate::AVG:   return "AVG";
+        case Aggregate::MIN:   return "MIN";
+        case Aggregate::MAX:   return "MAX";
+    }
+    return "COUNT";
+}
+
+// One aggregate column of a materialized view (Database::defineMaterializedView)
+struct ViewAggregate {
+    Aggregate fn;
+    std::string column; // Source column; empty or "*" for COUNT(*)
+    std::string as;     // Result column (default: "<fn>_<column>", or "count" for COUNT(*))
+};
+
+// Output formats for Table::exportTo
+enum class ExportFormat {
+    CSV,    // RFC 4180, optional header row
+    NDJSON  // One JSON object per line
+};
+
+struct ExportOptions {
+    bool header = true;             // CSV only: first line holds the column names
+    char delimiter = ',';           // CSV only
+    size_t bufferBytes = 1 << 20;   // Output is written to the stream in blocks of this size
+};
+
+// Change data capture (Database::subscribe)
+enum class ChangeOp {
+    INSERT = SQLITE_INSERT,
+    UPDATE = SQLITE_UPDATE,
+    DELETE = SQLITE_DELETE
+};
+
+struct ChangeEvent {
+    ChangeOp op;
+    std::string table;
+    long long rowid = 0;
+    std::optional<Row> oldValues; // UPDATE/DELETE, when values are captured
+    std::optional<Row> newValues; // INSERT/UPDATE, when values are captured
+};
+
+// One committed transaction's changes to the subscribed table
+using ChangeCallback = std::function<void(const std::vector<ChangeEvent>&)>;
+
+struct SubscribeOptions {
+    bool values = false; // Capture old/new column values (needs SQLITE_ENABLE_PREUPDATE_HOOK)
+};
+
+// Live queries (Table::watch)
+struct WatchOptions {
+    std::chrono::milliseconds debounce{50}; // Wait this long after a commit before re-running, folding later commits in
+    std::vector<std::string> key;           // Result columns identifying a row (default: the table's primary key)
+};
+
+// What changed in a live query's result since the previous delivery, matched by key
+struct WatchDelta {
+    std::vector<Row> added;
+    std::vector<Row> removed;
+    std::vector<Row> changed; // New versions of rows whose key stayed but whose values differ
 };
 
 // ==========================================
 // 2. Internal Context & RAII Helpers
 // ==========================================
 
-struct DBContext {
-    sqlite3* db = nullptr;
-    std::mutex mtx;
-
-    // LRU Cache Data Structures
-    // Use shared_ptr with custom deleter handling finalized statement
-    using StmtPtr = std::shared_ptr<sqlite3_stmt>;
-    using CacheEntry = std::pair<StmtPtr, std::list<std::string>::iterator>;
-    std::unordered_map<std::string, CacheEntry> statementCache;
-    std::list<std::string> lruList; // Front = MRU, Back = LRU
-    const size_t MAX_CACHE_SIZE = 64;
+// Approximate heap footprint of a Row: map nodes, names and payloads
+inline size_t approxRowBytes(const Row& row) {
+    size_t bytes = 0;
+    for (const auto& [name, value] : row) {
+        bytes += 64 + name.capacity();
+        if (auto str = std::get_if<std::string>(&value)) bytes += str->capacity();
+        else if (auto blob = std::get_if<std::vector<char>>(&value)) bytes += blob->capacity();
+    }
+    return bytes;
+}
 
-    DBContext(const std::string& filename, const Config& config = {}) {
-        if (sqlite3_open(filename.c_str(), &db) != SQLITE_OK) {
-            std::string err = db ? sqlite3_errmsg(db) : "Unknown error";
-             if (db) { sqlite3_close(db); db = nullptr; }
-            throw std::runtime_error("Can't open database: " + err);
+inline SQLValue sqliteValueToSQLValue(sqlite3_value* v) {
+    switch (sqlite3_value_type(v)) {
+        case SQLITE_INTEGER:
+            return (long long)sqlite3_value_int64(v);
+        case SQLITE_FLOAT:
+            return sqlite3_value_double(v);
+        case SQLITE_TEXT:
+            return std::string(reinterpret_cast<const char*>(sqlite3_value_text(v)), sqlite3_value_bytes(v));
+        case SQLITE_BLOB: {
+            const char* blob = reinterpret_cast<const char*>(sqlite3_value_blob(v));
+            return std::vector<char>(blob, blob + sqlite3_value_bytes(v));
         }
+        case SQLITE_NULL:
+        default:
+            return nullptr;
+    }
+}
 
-        char* errMsg = nullptr;
+// Column type for a declared SQL type, following SQLite's affinity rules
+inline SQLType declTypeToSQLType(std::string decl) {
+    std::transform(decl.begin(), decl.end(), decl.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    if (decl.find("INT") != std::string::npos) return SQLType::INTEGER;
+    if (decl.find("CHAR") != std::string::npos || decl.find("CLOB") != std::string::npos || decl.find("TEXT") != std::string::npos) return SQLType::TEXT;
+    if (decl.empty() || decl.find("BLOB") != std::string::npos) return SQLType::BLOB;
+    return SQLType::REAL;
+}
 
-        // 1. Foreign Keys
-        std::string fkPragma = config.enableForeignKeys ? "PRAGMA foreign_keys = ON;" : "PRAGMA foreign_keys = OFF;";
-        if (sqlite3_exec(db, fkPragma.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
-             // Handle error or log
-             if(errMsg) sqlite3_free(errMsg);
-        }
+// ASCII lower case, for comparing SQL identifiers (SQLite folds only ASCII letters)
+inline std::string asciiLower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(c < 0x80 ? std::tolower(c) : c); });
+    return s;
+}
 
-        // 2. Journal Mode (WAL)
-        if (config.enableWAL) {
-             sqlite3_exec(db, "PRAGMA journal_mode = WAL;", nullptr, nullptr, nullptr);
+// Appends a type-tagged, length-prefixed encoding of 'v' to 'key', so that distinct value
+// sequences never produce the same key
+inline void appendValueKey(std::string& key, const SQLValue& v) {
+    key += static_cast<char>('0' + v.index()); // Type tag: 1 and 1LL must not collide with "1"
+    std::visit([&](auto&& arg) {
+        using T = std::decay_t<decltype(arg)>;
+        if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::vector<char>>) {
+            uint32_t n = static_cast<uint32_t>(arg.size());
+            key.append(reinterpret_cast<const char*>(&n), sizeof(n));
+            key.append(arg.data(), arg.size());
+        } else if constexpr (!std::is_same_v<T, std::nullptr_t>) {
+            key.append(reinterpret_cast<const char*>(&arg), sizeof(arg));
         }
+    }, v);
+}
 
-        // 3. Synchronous Mode
-        const char* syncPragma = "PRAGMA synchronous = NORMAL;";
-        switch(config.synchronous) {
-            case SyncMode::OFF: syncPragma = "PRAGMA synchronous = OFF;"; break;
-            case SyncMode::FULL: syncPragma = "PRAGMA synchronous = FULL;"; break;
-            case SyncMode::EXTRA: syncPragma = "PRAGMA synchronous = EXTRA;"; break;
-            default: break; // Maintain NORMAL or default
+// Cache of select() results keyed by SQL text plus bound values. Each entry lists the
+// tables it read (base table and joins, lowercased); a write to any of them drops the
+// entry. Entries also expire after their TTL, and the least recently used go first once
+// the memory budget is exceeded. Lives in DBContext and is only touched with DBContext::mtx held.
+class ResultCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t invalidations = 0;
+        uint64_t expirations = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    ResultCache(size_t maxBytes, std::chrono::milliseconds ttl) : budget(maxBytes), defaultTtl(ttl) {}
+
+    static std::string makeKey(const std::string& sql, const std::vector<Condition>& where, const std::vector<Condition>& having) {
+        std::string key = sql;
+        key += '\0';
+        for (const auto& c : where) appendValueKey(key, c.value);
+        for (const auto& c : having) appendValueKey(key, c.value);
+        return key;
+    }
+
+    const std::vector<Row>* get(const std::string& key) {
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            ++st.misses;
+            return nullptr;
         }
-        sqlite3_exec(db, syncPragma, nullptr, nullptr, nullptr);
+        if (std::chrono::steady_clock::now() >= it->second.expires) {
+            erase(it);
+            ++st.expirations;
+            ++st.misses;
+            return nullptr;
+        }
+        lru.splice(lru.begin(), lru, it->second.lruPos);
+        ++st.hits;
+        return &it->second.rows;
     }
 
-    ~DBContext() {
-        // Smart pointers clean up statements automatically when refcount hits 0.
-        statementCache.clear();
-        lruList.clear();
+    void put(const std::string& key, const std::vector<Row>& rows, const std::vector<std::string>& tables, std::chrono::milliseconds ttl) {
+        auto old = entries.find(key);
+        if (old != entries.end()) erase(old);
 
-        if (db) {
-            sqlite3_close(db);
+        size_t bytes = key.size() + 128;
+        for (const auto& r : rows) bytes += approxRowBytes(r);
+        if (bytes > budget) return;
+
+        lru.push_front(key);
+        Entry& e = entries[key];
+        e.rows = rows;
+        e.tables = tables;
+        std::sort(e.tables.begin(), e.tables.end());
+        e.tables.erase(std::unique(e.tables.begin(), e.tables.end()), e.tables.end()); // Self-joins
+        e.bytes = bytes;
+        e.expires = std::chrono::steady_clock::now() + (ttl.count() > 0 ? ttl : defaultTtl);
+        e.lruPos = lru.begin();
+        for (const auto& t : tables) byTable[t].insert(key);
+        used += bytes;
+
+        while (used > budget && !lru.empty()) {
+            erase(entries.find(lru.back()));
+            ++st.evictions;
         }
     }
 
-    std::shared_ptr<sqlite3_stmt> getStatement(const std::string& sql) {
-        auto it = statementCache.find(sql);
-        if (it != statementCache.end()) {
-            // Found! Move to front of LRU list (Mark as Recently Used)
-            lruList.erase(it->second.second);
-            lruList.push_front(sql);
-            it->second.second = lruList.begin();
-            return it->second.first;
+    // A row of 'table' changed: drop every entry that read it. Entries list their tables
+    // lowercased, while the hook reports the schema's spelling.
+    void invalidateTable(const char* table) {
+        auto it = byTable.find(asciiLower(table));
+        if (it == byTable.end()) return;
+        std::vector<std::string> keys(it->second.begin(), it->second.end());
+        for (const auto& key : keys) {
+            erase(entries.find(key));
+            ++st.invalidations;
         }
+    }
 
-        // Not found. Check capacity.
-        if (statementCache.size() >= MAX_CACHE_SIZE) {
-            // Evict LRU (Back of list)
-            std::string lruSql = lruList.back();
-            auto cacheIt = statementCache.find(lruSql);
-            if (cacheIt != statementCache.end()) {
-                // Remove from map. Shared_ptr destructor handles finalize if it's the last ref.
-                statementCache.erase(cacheIt);
-            }
-            lruList.pop_back();
-        }
+    void clear() {
+        st.invalidations += entries.size();
+        entries.clear();
+        byTable.clear();
+        lru.clear();
+        used = 0;
+    }
 
-        // Create new
-        sqlite3_stmt* rawStmt = nullptr;
-        if (sqlite3_prepare_v2(db, sql.c_str(), -1, &rawStmt, nullptr) != SQLITE_OK) {
-            throw std::runtime_error("Prepare failed: " + std::string(sqlite3_errmsg(db)) + " SQL: " + sql);
-        }
-        
-        // Wrap in shared_ptr with custom deleter
-        std::shared_ptr<sqlite3_stmt> stmt(rawStmt, [](sqlite3_stmt* s) {
-            sqlite3_finalize(s);
-        });
+    Stats stats() const {
+        Stats out = st;
+        out.entries = entries.size();
+        out.bytes = used;
+        return out;
+    }
 
-        // Add to cache (Front of list)
-        lruList.push_front(sql);
-        statementCache[sql] = {stmt, lruList.begin()};
-        
-        return stmt;
+private:
+    struct Entry {
+        std::vector<Row> rows;
+        std::vector<std::string> tables;
+        size_t bytes = 0;
+        std::chrono::steady_clock::time_point expires;
+        std::list<std::string>::iterator lruPos;
+    };
+    std::unordered_map<std::string, Entry> entries;
+    std::unordered_map<std::string, std::unordered_set<std::string>> byTable; // table -> keys of live entries
+    std::list<std::string> lru; // Front = MRU
+    size_t budget;
+    size_t used = 0;
+    std::chrono::milliseconds defaultTtl;
+    Stats st;
+
+    void erase(std::unordered_map<std::string, Entry>::iterator it) {
+        for (const auto& t : it->second.tables) {
+            auto deps = byTable.find(t);
+            deps->second.erase(it->first);
+            if (deps->second.empty()) byTable.erase(deps);
+        }
+        used -= it->second.bytes;
+        lru.erase(it->second.lruPos);
+        entries.erase(it);
     }
 };
 
-class ScopedStmt {
-    std::shared_ptr<sqlite3_stmt> stmt;
+// Lock-free multi-producer / single-consumer FIFO (Vyukov). push() never blocks;
+// pop() and hasItems() may only be called from the one consumer thread.
+template<typename T>
+class MpscQueue {
 public:
-    ScopedStmt(std::shared_ptr<DBContext> ctx, const std::string& sql) {
-        stmt = ctx->getStatement(sql);
+    MpscQueue() : head(new Node), tail(head.load()) {}
+    ~MpscQueue() {
+        T discard;
+        while (pop(discard)) {}
+        delete tail;
     }
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
 
-    ~ScopedStmt() {
-        if (stmt) {
-            sqlite3_clear_bindings(stmt.get());
-            sqlite3_reset(stmt.get());
-        }
+    void push(T value) {
+        Node* node = new Node;
+        node->value = std::move(value);
+        Node* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
     }
 
-    operator sqlite3_stmt*() const { return stmt.get(); }
-    sqlite3_stmt* get() const { return stmt.get(); }
-};
+    bool pop(T& out) {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next) return false;
+        out = std::move(next->value);
+        delete tail;
+        tail = next; // 'next' becomes the stub
+        return true;
+    }
 
-// ==========================================
-// 1.5. ORM / Reflection Helpers
-// ==========================================
+    bool hasItems() const { return tail->next.load(std::memory_order_acquire) != nullptr; }
 
-template<typename Class, typename Member>
-struct FieldMapping {
-    Member Class::* ptr;
-    std::string name;
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value;
+    };
+    std::atomic<Node*> head; // Last pushed node; producers swap themselves in here
+    Node* tail;              // Already-consumed stub; tail->next is the oldest item
 };
 
-template<typename Class, typename Member>
-FieldMapping<Class, Member> orm_field(Member Class::* ptr, const std::string& name) {
-    return {ptr, name};
-}
+// Change data capture behind Database::subscribe. The writing thread records row changes
+// from the update (or preupdate) hook into a per-transaction buffer, coalescing repeated
+// changes to the same row. The commit hook only stages the buffer, since the commit can
+// still fail; once it is confirmed (DBContext::confirmCommit) the batch goes to a consumer
+// thread through a lock-free queue, and the consumer invokes subscriber callbacks. A
+// rollback discards the buffer and any staged batch. Capture state is guarded by DBContext::mtx (the hooks run under it);
+// callbacks are guarded by subMtx and never run with DBContext::mtx held.
+class ChangeFeed {
+public:
+    struct Stats {
+        uint64_t transactions = 0; // Committed transactions with captured changes
+        uint64_t events = 0;       // Events delivered after coalescing
+        uint64_t coalesced = 0;    // Changes folded into an earlier event for the same row
+        uint64_t discarded = 0;    // Changes dropped by rollbacks
+        uint64_t pending = 0;      // Transactions queued but not yet delivered
+        uint64_t callbackErrors = 0;
+    };
 
-// Default generic ORM trait - users specialize this
-template<typename T>
-struct ORM {
-    // static constexpr const char* table = ...;
-    // static auto map() { return std::make_tuple(...); }
-};
+    ChangeFeed() : consumer([this] { run(); }) {}
 
-// Helper for type coercion from SQLValue
+    // Delivers every batch already committed, then stops the consumer thread
+    ~ChangeFeed() {
+        stopping.store(true);
+        {
+            std::lock_guard<std::mutex> lock(wakeMtx);
+        }
+        wakeCv.notify_one();
+        consumer.join();
+    }
+
+    ChangeFeed(const ChangeFeed&) = delete;
+    ChangeFeed& operator=(const ChangeFeed&) = delete;
+
+    // Caller must hold DBContext::mtx. 'columns' are the table's columns in declaration
+    // order, used to name preupdate values.
+    size_t subscribe(const std::string& table, bool values, std::vector<std::string> columns, ChangeCallback cb) {
+        Capture& cap = captured[table];
+        ++cap.subscribers;
+        if (values) ++cap.valueSubscribers;
+        cap.columns = std::move(columns);
+
+        std::lock_guard<std::mutex> lock(subMtx);
+        size_t id = nextId++;
+        subscribers[id] = Subscriber{table, values, std::make_shared<ChangeCallback>(std::move(cb))};
+        return id;
+    }
+
+    // Caller must hold DBContext::mtx. A batch already being delivered may still reach
+    // the callback after this returns.
+    bool unsubscribe(size_t id) {
+        Subscriber sub;
+        {
+            std::lock_guard<std::mutex> lock(subMtx);
+            auto it = subscribers.find(id);
+            if (it == subscribers.end()) return false;
+            sub = std::move(it->second);
+            subscribers.erase(it);
+        }
+        auto cap = captured.find(sub.table);
+        if (sub.values) --cap->second.valueSubscribers;
+        if (--cap->second.subscribers == 0) captured.erase(cap);
+        return true;
+    }
+
+    bool hasSubscribers() const { return !captured.empty(); }
+
+    // Hook side: writer thread, DBContext::mtx held
+    void record(int op, const char* table, long long rowid) {
+        if (captured.find(table) == captured.end()) return;
+        add(ChangeEvent{static_cast<ChangeOp>(op), table, rowid, std::nullopt, std::nullopt});
+    }
+
+#if defined(SQLITE_ENABLE_PREUPDATE_HOOK)
+    void recordPreupdate(sqlite3* db, int op, const char* table, long long oldRowid, long long newRowid) {
+        auto cap = captured.find(table);
+        if (cap == captured.end()) return;
+
+        std::optional<Row> oldValues, newValues;
+        if (cap->second.valueSubscribers > 0) {
+            const auto& names = cap->second.columns;
+            int count = std::min<int>(sqlite3_preupdate_count(db), static_cast<int>(names.size()));
+            auto read = [&](int (*get)(sqlite3*, int, sqlite3_value**)) {
+                Row row;
+                for (int i = 0; i < count; ++i) {
+                    sqlite3_value* v = nullptr;
+                    row[names[i]] = get(db, i, &v) == SQLITE_OK && v ? sqliteValueToSQLValue(v) : SQLValue(nullptr);
+                }
+                return row;
+            };
+            if (op != SQLITE_INSERT) oldValues = read(&sqlite3_preupdate_old);
+            if (op != SQLITE_DELETE) newValues = read(&sqlite3_preupdate_new);
+        }
+
+        if (op == SQLITE_UPDATE && oldRowid != newRowid) {
+            // Rowid changed: report it as the old row leaving and the new one arriving
+            add(ChangeEvent{ChangeOp::DELETE, table, oldRowid, std::move(oldValues), std::nullopt});
+            add(ChangeEvent{ChangeOp::INSERT, table, newRowid, std::nullopt, std::move(newValues)});
+            return;
+        }
+        long long rowid = op == SQLITE_INSERT ? newRowid : oldRowid;
+        add(ChangeEvent{static_cast<ChangeOp>(op), table, rowid, std::move(oldValues), std::move(newValues)});
+    }
+#endif
+
+    // Commit hook: the transaction is about to commit. Returns whether a batch now waits
+    // for confirm(). A batch still staged here belongs to the same transaction (its COMMIT
+    // failed with SQLITE_BUSY and is being retried), since confirmation runs before the
+    // connection lock is released.
+    bool stage() {
+        for (auto& ev : pending) {
+            if (ev) staged.push_back(std::move(*ev));
+        }
+        pending.clear();
+        pendingIndex.clear();
+        return !staged.empty();
+    }
+
+    // The staged transaction has committed: hand it to the consumer
+    void confirm() {
+        if (staged.empty()) return;
+        st.transactions++;
+        st.events += staged.size();
+        enqueued.fetch_add(1, std::memory_order_relaxed);
+        queue.push(std::move(staged));
+        staged.clear();
+        if (sleeping.exchange(false)) {
+            std::lock_guard<std::mutex> lock(wakeMtx);
+            wakeCv.notify_one();
+        }
+    }
+
+    void rollback() {
+        for (const auto& ev : pending) {
+            if (ev) st.discarded++;
+        }
+        st.discarded += staged.size();
+        pending.clear();
+        pendingIndex.clear();
+        staged.clear();
+    }
+
+    // Blocks until every batch committed so far has been delivered. Must not be called
+    // from a callback or with DBContext::mtx held.
+    void flush() {
+        uint64_t target = enqueued.load();
+        std::unique_lock<std::mutex> lock(doneMtx);
+        doneCv.wait(lock, [&] { return delivered >= target; });
+    }
+
+    // Caller must hold DBContext::mtx
+    Stats stats() {
+        Stats out = st;
+        std::lock_guard<std::mutex> lock(doneMtx);
+        out.pending = enqueued.load() - delivered;
+        out.callbackErrors = callbackErrors;
+        return out;
+    }
+
+private:
+    struct Capture {
+        int subscribers = 0;
+        int valueSubscribers = 0;
+        std::vector<std::string> columns;
+    };
+    struct Subscriber {
+        std::string table;
+        bool values = false;
+        std::shared_ptr<ChangeCallback> callback;
+    };
+
+    // Writer side (DBContext::mtx)
+    std::unordered_map<std::string, Capture> captured;
+    std::vector<std::optional<ChangeEvent>> pending; // Current transaction; nullopt = cancelled out
+    std::unordered_map<std::string, std::unordered_map<long long, size_t>> pendingIndex; // table -> rowid -> pending slot
+    std::vector<ChangeEvent> staged; // Passed the commit hook, commit not yet confirmed
+    Stats st;
+
+    // Subscriber registry (subMtx)
+    std::mutex subMtx;
+    std::map<size_t, Subscriber> subscribers;
+    size_t nextId = 1;
+
+    // Hand-off to the consumer
+    MpscQueue<std::vector<ChangeEvent>> queue;
+    std::atomic<uint64_t> enqueued{0};
+    std::atomic<bool> sleeping{false};
+    std::atomic<bool> stopping{false};
+    std::mutex wakeMtx;
+    std::condition_variable wakeCv;
+    std::mutex doneMtx;
+    std::condition_variable doneCv;
+    uint64_t delivered = 0;      // doneMtx
+    uint64_t callbackErrors = 0; // doneMtx
+    std::thread consumer; // Last: starts after everything above is constructed
+
+    // Folds a change into the event already pending for the same row, if any
+    void add(ChangeEvent ev) {
+        auto& rows = pendingIndex[ev.table];
+        auto it = rows.find(ev.rowid);
+        if (it == rows.end()) {
+            rows.emplace(ev.rowid, pending.size());
+            pending.emplace_back(std::move(ev));
+            return;
+        }
+
+        ChangeEvent& prev = *pending[it->second];
+        st.coalesced++;
+        if (prev.op == ChangeOp::INSERT && ev.op == ChangeOp::DELETE) {
+            pending[it->second].reset(); // Row never existed outside the transaction
+            rows.erase(it);
+        } else if (prev.op == ChangeOp::DELETE && ev.op == ChangeOp::INSERT) {
+            prev.op = ChangeOp::UPDATE; // Rowid reused: net effect is an update
+            prev.newValues = std::move(ev.newValues);
+        } else if (ev.op == ChangeOp::DELETE) {
+            prev.op = ChangeOp::DELETE; // UPDATE then DELETE: keep the original old values
+            prev.newValues.reset();
+        } else {
+            prev.newValues = std::move(ev.newValues); // INSERT/UPDATE then UPDATE: latest values win
+        }
+    }
+
+    void run() {
+        std::vector<ChangeEvent> batch;
+        while (true) {
+            if (queue.pop(batch)) {
+                deliver(batch);
+                {
+                    std::lock_guard<std::mutex> lock(doneMtx);
+                    ++delivered;
+                }
+                doneCv.notify_all();
+                continue;
+            }
+            if (stopping.load()) break;
+
+            std::unique_lock<std::mutex> lock(wakeMtx);
+            sleeping.store(true);
+            wakeCv.wait(lock, [&] { return queue.hasItems() || stopping.load(); });
+            sleeping.store(false);
+        }
+    }
+
+    void deliver(const std::vector<ChangeEvent>& batch) {
+        std::vector<Subscriber> subs;
+        {
+            std::lock_guard<std::mutex> lock(subMtx);
+            for (const auto& [id, sub] : subscribers) subs.push_back(sub);
+        }
+
+        std::vector<ChangeEvent> events;
+        for (const auto& sub : subs) {
+            events.clear();
+            for (const auto& ev : batch) {
+                if (ev.table == sub.table) events.push_back(ev);
+            }
+            if (events.empty()) continue;
+            try {
+                (*sub.callback)(events);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(doneMtx);
+                ++callbackErrors;
+            }
+        }
+    }
+};
+
+// Runs WAL checkpoints on a background thread with its own connection, so no writer
+// commit pays for them (Database::startCheckpointer). Each interval it runs a PASSIVE
+// checkpoint. A writer only starts the WAL log over when every frame is backfilled and no
+// reader is still on it, which PASSIVE cannot promise under steady writes or long readers,
+// so once the log (as reported by the checkpoint, not the file size, which RESTART keeps)
+// outgrows the budget it escalates to RESTART or TRUNCATE. Those wait (up to busyTimeout)
+// for readers so the next writer starts over; after one succeeds the log is left alone
+// until it has moved.
+class CheckpointManager {
+public:
+    CheckpointManager(const std::string& path, const CheckpointOptions& options) : opts(options), walPath(path + "-wal") {
+        sqlite3* raw = nullptr;
+        int rc = sqlite3_open_v2(path.c_str(), &raw, SQLITE_OPEN_READWRITE, nullptr);
+        conn.reset(raw);
+        if (rc != SQLITE_OK) {
+            throw std::runtime_error("Checkpointer failed to open " + path + ": " + (raw ? sqlite3_errmsg(raw) : "out of memory"));
+        }
+        busyMs = static_cast<int>(opts.busyTimeout.count());
+        sqlite3_busy_handler(conn.get(), &CheckpointManager::busyWait, &busyMs);
+        // A connection only attaches to the WAL once it has read the database; until then
+        // checkpoints are no-ops reporting -1 frames
+        if (sqlite3_exec(conn.get(), "SELECT count(*) FROM sqlite_master;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            throw std::runtime_error("Checkpointer failed to read " + path + ": " + sqlite3_errmsg(conn.get()));
+        }
+        sqlite3_stmt* pageSize = nullptr;
+        if (sqlite3_prepare_v2(conn.get(), "PRAGMA page_size;", -1, &pageSize, nullptr) == SQLITE_OK
+            && sqlite3_step(pageSize) == SQLITE_ROW) {
+            pageBytes = sqlite3_column_int64(pageSize, 0);
+        }
+        sqlite3_finalize(pageSize);
+        worker = std::thread([this] { loop(); });
+    }
+
+    ~CheckpointManager() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_one();
+        worker.join();
+    }
+
+    CheckpointManager(const CheckpointManager&) = delete;
+    CheckpointManager& operator=(const CheckpointManager&) = delete;
+
+    CheckpointStats stats() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return st;
+    }
+
+    // Busy handler (argument: int* timeout in ms) for both sides of an escalated checkpoint.
+    // sqlite3_busy_timeout backs off 1, 2, 5, 10, ... ms, so a writer that finds the write
+    // lock held for 1 ms wakes up 8 ms later; the lock is only held briefly here, so poll
+    // every 50 us for the first millisecond before falling back to 1 ms naps.
+    static int busyWait(void* timeoutMs, int attempt) {
+        const int shortNaps = 20;
+        int64_t waitedMicros = attempt < shortNaps ? attempt * 50 : 1000 + int64_t(attempt - shortNaps) * 1000;
+        if (waitedMicros >= int64_t(*static_cast<int*>(timeoutMs)) * 1000) return 0;
+        std::this_thread::sleep_for(std::chrono::microseconds(attempt < shortNaps ? 50 : 1000));
+        return 1;
+    }
+
+private:
+    CheckpointOptions opts;
+    std::string walPath;
+    std::unique_ptr<sqlite3, decltype(&sqlite3_close)> conn{nullptr, &sqlite3_close};
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stopping = false; // mtx
+    CheckpointStats st;    // mtx
+    int prevFrames = 0;    // mtx: WAL position at the previous checkpoint
+    int prevBackfilled = 0;
+    int64_t pageBytes = 4096; // A WAL frame is one page plus a 24-byte header
+    int resetFrames = -1;     // Worker only: log length when an escalation last succeeded
+    int busyMs = 0;
+    std::thread worker;
+
+    int64_t walFileBytes() const {
+        std::ifstream wal(walPath, std::ios::binary | std::ios::ate);
+        return wal ? static_cast<int64_t>(wal.tellg()) : 0;
+    }
+
+    // Returns whether every frame of the log was backfilled; 'frames' is the log length
+    bool run(CheckpointMode mode, int& frames) {
+        frames = 0;
+        int backfilled = 0;
+        auto start = std::chrono::steady_clock::now();
+        int rc = sqlite3_wal_checkpoint_v2(conn.get(), "main", static_cast<int>(mode), &frames, &backfilled);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        int64_t walBytes = walFileBytes();
+
+        std::lock_guard<std::mutex> lock(mtx);
+        st.checkpoints++;
+        if (mode != CheckpointMode::PASSIVE) st.escalations++;
+        // PASSIVE reports SQLITE_OK even when readers kept it from finishing
+        if (rc == SQLITE_BUSY || (rc == SQLITE_OK && backfilled < frames)) st.busy++;
+        if (rc == SQLITE_OK || rc == SQLITE_BUSY) {
+            // Counts run from the start of the current WAL. TRUNCATE reports 0/0 once done,
+            // and a smaller count otherwise means a writer started the WAL over.
+            int copied;
+            if (frames == 0 && rc == SQLITE_OK) copied = prevFrames - prevBackfilled;
+            else if (backfilled >= prevBackfilled) copied = backfilled - prevBackfilled;
+            else copied = backfilled;
+            st.framesBackfilled += static_cast<uint64_t>(std::max(0, copied));
+            prevFrames = frames;
+            prevBackfilled = backfilled;
+            st.walFrames = frames;
+        }
+        st.walBytes = walBytes;
+        st.lastMillis = ms;
+        st.maxMillis = std::max(st.maxMillis, ms);
+        st.totalMillis += ms;
+        return rc == SQLITE_OK && backfilled >= frames;
+    }
+
+    void loop() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (!cv.wait_for(lock, opts.interval, [&] { return stopping; })) {
+            lock.unlock();
+            int frames = 0;
+            run(CheckpointMode::PASSIVE, frames);
+            if (frames != resetFrames && frames * (pageBytes + 24) > opts.walBudgetBytes) {
+                int after = 0;
+                resetFrames = run(opts.escalation, after) ? after : -1;
+            }
+            lock.lock();
+        }
+    }
+};
+
+// Latency recordings of one Database, split by operation and phase. Every thread
+// records into its own recorder (found through a thread_local list keyed by registry
+// id, so no lock and no shared cache line on the recording path); snapshot() merges
+// them. Recorders outlive their threads, so nothing recorded is lost.
+class MetricsRegistry {
+    // Written by its owning thread only (plain load + store), read by snapshot()
+    struct AtomicHistogram {
+        std::array<std::atomic<uint64_t>, LatencyHistogram::BUCKETS> counts{};
+        std::atomic<uint64_t> total{0}, sum{0}, max{0};
+
+        void record(uint64_t nanos) {
+            auto bump = [](std::atomic<uint64_t>& a, uint64_t by) {
+                a.store(a.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+            };
+            bump(counts[LatencyHistogram::bucketOf(nanos)], 1);
+            bump(total, 1);
+            bump(sum, nanos);
+            if (nanos > max.load(std::memory_order_relaxed)) max.store(nanos, std::memory_order_relaxed);
+        }
+    };
+
+    struct Recorder {
+        std::array<std::array<AtomicHistogram, METRIC_PHASES>, METRIC_OPS> histograms;
+    };
+
+    static uint64_t nextId() {
+        static std::atomic<uint64_t> ids{1};
+        return ids.fetch_add(1);
+    }
+
+    const uint64_t id = nextId(); // Never reused, so stale thread_local entries can't match
+    mutable std::mutex recordersMtx;
+    std::vector<std::unique_ptr<Recorder>> recorders;
+
+    Recorder& local() {
+        thread_local std::vector<std::pair<uint64_t, Recorder*>> mine;
+        for (const auto& [regId, rec] : mine) {
+            if (regId == id) return *rec;
+        }
+        std::lock_guard<std::mutex> lock(recordersMtx);
+        recorders.push_back(std::make_unique<Recorder>());
+        mine.emplace_back(id, recorders.back().get());
+        return *recorders.back();
+    }
+
+public:
+    void record(MetricOp op, MetricPhase phase, uint64_t nanos) {
+        local().histograms[static_cast<size_t>(op)][static_cast<size_t>(phase)].record(nanos);
+    }
+
+    MetricsSnapshot snapshot() const {
+        MetricsSnapshot snap;
+        std::lock_guard<std::mutex> lock(recordersMtx);
+        for (const auto& rec : recorders) {
+            for (size_t o = 0; o < METRIC_OPS; ++o) {
+                for (size_t p = 0; p < METRIC_PHASES; ++p) {
+                    const auto& src = rec->histograms[o][p];
+                    if (!src.total.load(std::memory_order_relaxed)) continue;
+                    auto& dst = snap.histograms[o][p];
+                    uint64_t sum = src.sum.load(std::memory_order_relaxed);
+                    uint64_t max = src.max.load(std::memory_order_relaxed);
+                    for (int b = 0; b < LatencyHistogram::BUCKETS; ++b) {
+                        uint64_t n = src.counts[b].load(std::memory_order_relaxed);
+                        if (n) {
+                            dst.add(b, n, sum, max); // Sum is carried by the first non-empty bucket
+                            sum = 0;
+                        }
+                    }
+                }
+            }
+        }
+        return snap;
+    }
+
+    // Clears all recorders. Recordings made concurrently may be partly kept.
+    void reset() {
+        std::lock_guard<std::mutex> lock(recordersMtx);
+        for (const auto& rec : recorders) {
+            for (auto& perOp : rec->histograms) {
+                for (auto& h : perOp) {
+                    for (auto& c : h.counts) c.store(0, std::memory_order_relaxed);
+                    h.total.store(0, std::memory_order_relaxed);
+                    h.sum.store(0, std::memory_order_relaxed);
+                    h.max.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+};
+
+// Times one Table/Database operation phase by phase. split(p) charges the time since the
+// previous split to phase p (repeated splits add up, e.g. per-row STEP/MATERIALIZE), and
+// the destructor records every charged phase plus TOTAL. With a null registry (metrics
+// off) nothing reads the clock.
+class OpTimer {
+    using Clock = std::chrono::steady_clock;
+    MetricsRegistry* registry;
+    MetricOp op;
+    Clock::time_point start, mark;
+    std::array<uint64_t, METRIC_PHASES> phases{};
+    unsigned charged = 0; // Bit per phase
+
+public:
+    OpTimer(MetricsRegistry* reg, MetricOp o) : registry(reg), op(o) {
+        if (registry) start = mark = Clock::now();
+    }
+
+    OpTimer(const OpTimer&) = delete;
+    OpTimer& operator=(const OpTimer&) = delete;
+
+    void split(MetricPhase phase) {
+        if (!registry) return;
+        auto now = Clock::now();
+        phases[static_cast<size_t>(phase)] += static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - mark).count());
+        charged |= 1u << static_cast<unsigned>(phase);
+        mark = now;
+    }
+
+    ~OpTimer() {
+        if (!registry) return;
+        registry->record(op, MetricPhase::TOTAL, static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()));
+        for (size_t p = 1; p < METRIC_PHASES; ++p) {
+            if (charged & (1u << p)) registry->record(op, static_cast<MetricPhase>(p), phases[p]);
+        }
+    }
+};
+
+// DBContext's connection lock. Waiters queue per LockPriority and the releasing thread
+// hands the lock directly to the next one: the oldest interactive waiter, unless the
+// oldest batch waiter has waited longer than batchMaxWait, so bulk work still progresses
+// under a steady interactive load. Wait and hold times are kept in total, per priority
+// class and per call site (the string literal passed to ContextLock), all under the
+// small internal mutex.
+class ContextMutex {
+    using Clock = std::chrono::steady_clock;
+    static constexpr size_t SITE_SLOTS = 128; // The last slot collects sites that don't fit
+
+    struct Waiter {
+        std::condition_variable cv;
+        Clock::time_point since;
+        bool granted = false;
+        Waiter* next = nullptr;
+    };
+
+    struct Site {
+        const char* name = nullptr;
+        LockCounters counters;
+    };
+
+    mutable std::mutex state;
+    bool held = false;
+    std::array<Waiter*, 2> first{}, last{}; // Intrusive FIFO per priority; waiters live on their stacks
+    std::array<size_t, 2> queued{};
+    std::chrono::nanoseconds batchMaxWait{std::chrono::milliseconds(100)};
+
+    // Current holder, for hold time
+    Site* holderSite = nullptr;
+    size_t holderClass = 0;
+    Clock::time_point acquiredAt;
+
+    // One-shot callback run by the holder just before it releases the lock (onNextUnlock)
+    void (*beforeUnlock)(void*) = nullptr;
+    void* beforeUnlockArg = nullptr;
+
+    LockCounters total;
+    std::array<LockCounters, 2> byClass{};
+    std::array<Site, SITE_SLOTS> sites{};
+    uint64_t depthSum = 0;
+    size_t maxDepth = 0;
+    uint64_t batchYields = 0;
+
+    static uint64_t nanosSince(Clock::time_point start, Clock::time_point end) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+
+    // Open addressing on the literal's address: no allocation on the lock path
+    Site* siteFor(const char* name) {
+        if (!name) name = "unattributed";
+        size_t slot = (reinterpret_cast<uintptr_t>(name) >> 3) * 0x9E3779B97F4A7C15ull % (SITE_SLOTS - 1);
+        for (size_t probe = 0; probe < SITE_SLOTS - 1; ++probe, slot = (slot + 1) % (SITE_SLOTS - 1)) {
+            if (sites[slot].name == name) return &sites[slot];
+            if (!sites[slot].name) {
+                sites[slot].name = name;
+                return &sites[slot];
+            }
+        }
+        sites[SITE_SLOTS - 1].name = "other";
+        return &sites[SITE_SLOTS - 1];
+    }
+
+    static void countAcquire(LockCounters& c, bool contended, uint64_t waited) {
+        ++c.acquisitions;
+        if (!contended) return;
+        ++c.contended;
+        c.waitNanos += waited;
+        c.maxWaitNanos = std::max(c.maxWaitNanos, waited);
+    }
+
+    static void countRelease(LockCounters& c, uint64_t heldFor) {
+        c.holdNanos += heldFor;
+        c.maxHoldNanos = std::max(c.maxHoldNanos, heldFor);
+    }
+
+    // Caller holds 'state' and now owns the lock
+    void acquired(const char* site, size_t cls, bool contended, uint64_t waited) {
+        holderSite = siteFor(site);
+        holderClass = cls;
+        countAcquire(total, contended, waited);
+        countAcquire(byClass[cls], contended, waited);
+        countAcquire(holderSite->counters, contended, waited);
+        acquiredAt = Clock::now();
+    }
+
+public:
+    void lock(const char* site) {
+        size_t cls = static_cast<size_t>(currentLockPriority());
+        std::unique_lock<std::mutex> guard(state);
+        if (!held) {
+            held = true;
+            acquired(site, cls, false, 0);
+            return;
+        }
+        size_t depth = queued[0] + queued[1];
+        depthSum += depth;
+        maxDepth = std::max(maxDepth, depth + 1);
+        Waiter self;
+        if (last[cls]) last[cls]->next = &self; else first[cls] = &self;
+        last[cls] = &self;
+        ++queued[cls];
+        self.since = Clock::now();
+        self.cv.wait(guard, [&] { return self.granted; });
+        acquired(site, cls, true, nanosSince(self.since, Clock::now()));
+    }
+
+    void lock() { lock(nullptr); }
+
+    // How long a batch waiter can be passed over by interactive ones (Config::batchLockMaxWaitMs)
+    void setBatchMaxWait(std::chrono::nanoseconds wait) {
+        std::lock_guard<std::mutex> guard(state);
+        batchMaxWait = wait;
+    }
+
+    bool try_lock() {
+        std::lock_guard<std::mutex> guard(state);
+        if (held) return false;
+        held = true;
+        acquired(nullptr, static_cast<size_t>(currentLockPriority()), false, 0);
+        return true;
+    }
+
+    // Holder only: runs fn(arg), still holding the lock, just before it is next released.
+    // fn may re-arm itself.
+    void onNextUnlock(void (*fn)(void*), void* arg) {
+        beforeUnlock = fn;
+        beforeUnlockArg = arg;
+    }
+
+    void unlock() {
+        if (beforeUnlock) {
+            auto fn = beforeUnlock;
+            beforeUnlock = nullptr;
+            fn(beforeUnlockArg);
+        }
+        auto now = Clock::now();
+        std::lock_guard<std::mutex> guard(state);
+        uint64_t heldFor = nanosSince(acquiredAt, now);
+        countRelease(total, heldFor);
+        countRelease(byClass[holderClass], heldFor);
+        countRelease(holderSite->counters, heldFor);
+
+        const size_t INTERACTIVE = 0, BATCH = 1;
+        if (!first[INTERACTIVE] && !first[BATCH]) {
+            held = false;
+            return;
+        }
+        size_t next = first[INTERACTIVE] ? INTERACTIVE : BATCH;
+        if (first[INTERACTIVE] && first[BATCH] && now - first[BATCH]->since >= batchMaxWait) {
+            next = BATCH;
+            ++batchYields;
+        }
+
+        // Handoff: 'held' stays true so no arriving thread can barge in ahead of the queue
+        Waiter* w = first[next];
+        first[next] = w->next;
+        if (!first[next]) last[next] = nullptr;
+        --queued[next];
+        w->granted = true;
+        w->cv.notify_one(); // Under 'state', so the waiter can't return and destroy 'w' first
+    }
+
+    LockStats stats() const {
+        std::lock_guard<std::mutex> guard(state);
+        LockStats st;
+        static_cast<LockCounters&>(st) = total;
+        st.byPriority = byClass;
+        st.queueDepth = queued[0] + queued[1];
+        st.maxQueueDepth = maxDepth;
+        st.meanQueueDepth = total.contended ? static_cast<double>(depthSum) / total.contended : 0.0;
+        st.batchYields = batchYields;
+        for (const auto& site : sites) {
+            if (!site.name || site.counters.acquisitions == 0) continue;
+            LockSiteStats ss;
+            static_cast<LockCounters&>(ss) = site.counters;
+            ss.site = site.name;
+            st.sites.push_back(std::move(ss));
+        }
+        std::sort(st.sites.begin(), st.sites.end(), [](const LockSiteStats& a, const LockSiteStats& b) {
+            return a.waitNanos != b.waitNanos ? a.waitNanos > b.waitNanos : a.holdNanos > b.holdNanos;
+        });
+        return st;
+    }
+
+    // Site names are kept so the current holder's slot stays valid
+    void resetStats() {
+        std::lock_guard<std::mutex> guard(state);
+        total = LockCounters{};
+        byClass = {};
+        for (auto& site : sites) site.counters = LockCounters{};
+        depthSum = 0;
+        maxDepth = queued[0] + queued[1];
+        batchYields = 0;
+    }
+};
+
+// Holds a ContextMutex for a scope, attributing the wait and hold time to 'site'
+// (a string literal naming the call site, e.g. "Table::select")
+class ContextLock {
+    ContextMutex& mutex;
+
+public:
+    ContextLock(ContextMutex& m, const char* site) : mutex(m) { mutex.lock(site); }
+    ~ContextLock() { mutex.unlock(); }
+    ContextLock(const ContextLock&) = delete;
+    ContextLock& operator=(const ContextLock&) = delete;
+};
+
+struct DBContext {
+    sqlite3* db = nullptr;
+    ContextMutex mtx;
+
+    // Operation metrics. The registry is created on first enable and kept until the
+    // context dies, so a timer that loaded the pointer before a disable stays valid.
+    std::unique_ptr<MetricsRegistry> metricsStore; // mtx
+    std::atomic<MetricsRegistry*> metrics{nullptr};
+
+    MetricsRegistry* activeMetrics() const { return metrics.load(std::memory_order_acquire); }
+
+    // Read budgets (QueryBudget); counters are read without the lock
+    std::chrono::milliseconds queryTimeout{0}; // Config::queryTimeoutMs
+    std::atomic<uint64_t> timeouts{0};
+    std::atomic<uint64_t> cancellations{0};
+    std::atomic<uint64_t> lostNanos{0};
+    std::atomic<uint64_t> maxLostNanos{0};
+
+    // LRU Cache Data Structures
+    // Use shared_ptr with custom deleter handling finalized statement
+    using StmtPtr = std::shared_ptr<sqlite3_stmt>;
+    using CacheEntry = std::pair<StmtPtr, std::list<std::string>::iterator>;
+    std::unordered_map<std::string, CacheEntry> statementCache;
+    std::list<std::string> lruList; // Front = MRU, Back = LRU
+    const size_t MAX_CACHE_SIZE = 64;
+
+    // Change hooks. SQLite allows one update/commit/rollback hook per connection, so
+    // DBContext owns them and fans out to listeners (row cache, result cache, ...).
+    // Callbacks run on the writing thread while it holds 'mtx' and must not call back
+    // into Table/Database or run SQL.
+    struct HookListener {
+        std::function<void(int op, const char* table, sqlite3_int64 rowid)> onUpdate;
+        std::function<void()> onCommit;   // Transaction is about to commit
+        std::function<void()> onRollback;
+    };
+    std::map<size_t, HookListener> hookListeners;
+    size_t nextListenerId = 1;
+
+    // Tables a listener must see every deleted row of (see authorizer), in asciiLower
+    // form. Only grows while listeners are installed.
+    std::unordered_set<std::string> rowByRowDeletes;
+    bool authorizerInstalled = false;
+    std::string droppingTable; // authorizer(): table named by the DROP being compiled
+
+    // Optional select() result cache (Database::enableResultCache)
+    std::unique_ptr<ResultCache> resultCache;
+    size_t resultCacheListener = 0;
+
+    // Change data capture (Database::subscribe)
+    std::unique_ptr<ChangeFeed> changeFeed;
+    size_t changeFeedListener = 0;
+
+    // Image a read-only deserialized database reads from in place (Database::fromImage);
+    // released after the connection closes
+    DatabaseImage image;
+
+    // Background WAL checkpointer (Database::startCheckpointer) and the writer's
+    // wal_autocheckpoint / busy_timeout / journal_size_limit settings to restore when it stops
+    std::unique_ptr<CheckpointManager> checkpointer;
+    int savedAutocheckpoint = 1000;
+    int savedBusyTimeout = 0;
+    int64_t savedJournalSizeLimit = -1;
+    int checkpointBusyMs = 0; // Writer's busy wait while the checkpointer runs (CheckpointManager::busyWait)
+
+    // Caller must hold mtx
+    size_t addHookListener(HookListener listener) {
+        if (hookListeners.empty()) {
+            sqlite3_update_hook(db, &DBContext::updateHook, this);
+            sqlite3_commit_hook(db, &DBContext::commitHook, this);
+            sqlite3_rollback_hook(db, &DBContext::rollbackHook, this);
+        }
+        size_t id = nextListenerId++;
+        hookListeners.emplace(id, std::move(listener));
+        return id;
+    }
+
+    // Caller must hold mtx
+    void removeHookListener(size_t id) {
+        hookListeners.erase(id);
+        if (hookListeners.empty()) {
+            sqlite3_update_hook(db, nullptr, nullptr);
+            sqlite3_commit_hook(db, nullptr, nullptr);
+            sqlite3_rollback_hook(db, nullptr, nullptr);
+            if (authorizerInstalled) sqlite3_set_authorizer(db, nullptr, nullptr);
+            authorizerInstalled = false;
+            rowByRowDeletes.clear();
+        }
+    }
+
+    // Makes DELETE without WHERE on table 'lowerName' (asciiLower) report every row to the
+    // update hook. Setting
+    // the authorizer expires every prepared statement, so statements compiled with the
+    // truncate optimization are recompiled; that only happens when the set grows.
+    // Caller must hold mtx.
+    void trackDeletes(const std::string& lowerName) {
+        if (!rowByRowDeletes.insert(lowerName).second) return;
+        sqlite3_set_authorizer(db, &DBContext::authorizer, this);
+        authorizerInstalled = true;
+    }
+
+    // A DELETE without WHERE (from any SQL on this connection, triggers included) uses
+    // SQLite's truncate optimization, which drops the rows without calling the update hook.
+    // Answering SQLITE_IGNORE for the DELETE makes SQLite delete row by row instead, so
+    // listeners see every row; only tables in rowByRowDeletes pay for that. DROP statements
+    // also check SQLITE_DELETE, on the schema table and on the dropped table itself, and
+    // IGNORE would silently skip the drop; those pass.
+    static int authorizer(void* self, int action, const char* name, const char*, const char*, const char*) {
+        auto* ctx = static_cast<DBContext*>(self);
+        switch (action) {
+            case SQLITE_DROP_TABLE: case SQLITE_DROP_TEMP_TABLE: case SQLITE_DROP_VIEW: case SQLITE_DROP_TEMP_VIEW:
+                ctx->droppingTable = name ? name : "";
+                return SQLITE_OK;
+            case SQLITE_DELETE:
+                if (!name || std::strncmp(name, "sqlite_", 7) == 0) return SQLITE_OK;
+                if (ctx->droppingTable == name) {
+                    ctx->droppingTable.clear();
+                    return SQLITE_OK;
+                }
+                return ctx->rowByRowDeletes.count(asciiLower(name)) ? SQLITE_IGNORE : SQLITE_OK;
+            default:
+                return SQLITE_OK;
+        }
+    }
+
+    static void updateHook(void* self, int op, const char* /*dbName*/, const char* table, sqlite3_int64 rowid) {
+        for (auto& [id, l] : static_cast<DBContext*>(self)->hookListeners) {
+            if (l.onUpdate) l.onUpdate(op, table, rowid);
+        }
+    }
+    static int commitHook(void* self) {
+        for (auto& [id, l] : static_cast<DBContext*>(self)->hookListeners) {
+            if (l.onCommit) l.onCommit();
+        }
+        return 0; // Never veto the commit
+    }
+    static void rollbackHook(void* self) {
+        for (auto& [id, l] : static_cast<DBContext*>(self)->hookListeners) {
+            if (l.onRollback) l.onRollback();
+        }
+    }
+
+    // Armed on mtx by the change feed's commit hook. Every statement runs under mtx, so by
+    // the time it is released the COMMIT has either finished (back in autocommit), failed
+    // and rolled back (the rollback hook already dropped the batch), or failed with
+    // SQLITE_BUSY and left the transaction open for a retry or rollback (check again later).
+    static void confirmCommit(void* self) {
+        auto* ctx = static_cast<DBContext*>(self);
+        if (!ctx->changeFeed) return;
+        if (sqlite3_get_autocommit(ctx->db)) ctx->changeFeed->confirm();
+        else ctx->mtx.onNextUnlock(&DBContext::confirmCommit, ctx);
+    }
+#if defined(SQLITE_ENABLE_PREUPDATE_HOOK)
+    static void preupdateHook(void* self, sqlite3* db, int op, const char* /*dbName*/, const char* table,
+                              sqlite3_int64 oldRowid, sqlite3_int64 newRowid) {
+        auto* ctx = static_cast<DBContext*>(self);
+        if (ctx->changeFeed) ctx->changeFeed->recordPreupdate(db, op, table, oldRowid, newRowid);
+    }
+#endif
+
+    DBContext(const std::string& filename, const Config& config = {}) {
+        if (sqlite3_open(filename.c_str(), &db) != SQLITE_OK) {
+            std::string err = db ? sqlite3_errmsg(db) : "Unknown error";
+             if (db) { sqlite3_close(db); db = nullptr; }
+            throw std::runtime_error("Can't open database: " + err);
+        }
+
+        char* errMsg = nullptr;
+
+        // 0. Page size and auto-vacuum must be set before the first table (and before
+        //    WAL mode, which fixes the page size) is written
+        if (config.pageSize > 0) {
+            std::string pragma = "PRAGMA page_size = " + std::to_string(config.pageSize) + ";";
+            sqlite3_exec(db, pragma.c_str(), nullptr, nullptr, nullptr);
+        }
+        if (config.autoVacuum != AutoVacuum::NONE) {
+            sqlite3_exec(db, config.autoVacuum == AutoVacuum::FULL ? "PRAGMA auto_vacuum = FULL;"
+                                                                   : "PRAGMA auto_vacuum = INCREMENTAL;",
+                         nullptr, nullptr, nullptr);
+        }
+
+        // 1. Foreign Keys
+        std::string fkPragma = config.enableForeignKeys ? "PRAGMA foreign_keys = ON;" : "PRAGMA foreign_keys = OFF;";
+        if (sqlite3_exec(db, fkPragma.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+             // Handle error or log
+             if(errMsg) sqlite3_free(errMsg);
+        }
+
+        // 2. Journal Mode (WAL)
+        if (config.enableWAL) {
+             sqlite3_exec(db, "PRAGMA journal_mode = WAL;", nullptr, nullptr, nullptr);
+        }
+
+        // 3. Synchronous Mode
+        const char* syncPragma = "PRAGMA synchronous = NORMAL;";
+        switch(config.synchronous) {
+            case SyncMode::OFF: syncPragma = "PRAGMA synchronous = OFF;"; break;
+            case SyncMode::FULL: syncPragma = "PRAGMA synchronous = FULL;"; break;
+            case SyncMode::EXTRA: syncPragma = "PRAGMA synchronous = EXTRA;"; break;
+            default: break; // Maintain NORMAL or default
+        }
+        sqlite3_exec(db, syncPragma, nullptr, nullptr, nullptr);
+
+        // 4. Cache, memory mapping, temp storage, checkpoints, locking
+        if (config.cacheSizeKiB > 0) {
+            std::string pragma = "PRAGMA cache_size = -" + std::to_string(config.cacheSizeKiB) + ";";
+            sqlite3_exec(db, pragma.c_str(), nullptr, nullptr, nullptr);
+        }
+        if (config.mmapSize >= 0) {
+            std::string pragma = "PRAGMA mmap_size = " + std::to_string(config.mmapSize) + ";";
+            sqlite3_exec(db, pragma.c_str(), nullptr, nullptr, nullptr);
+        }
+        if (config.tempStore != TempStore::DEFAULT) {
+            sqlite3_exec(db, config.tempStore == TempStore::MEMORY ? "PRAGMA temp_store = MEMORY;"
+                                                                   : "PRAGMA temp_store = FILE;",
+                         nullptr, nullptr, nullptr);
+        }
+        if (config.walAutocheckpoint >= 0) sqlite3_wal_autocheckpoint(db, config.walAutocheckpoint);
+        if (config.busyTimeoutMs > 0) sqlite3_busy_timeout(db, config.busyTimeoutMs);
+
+        mtx.setBatchMaxWait(std::chrono::milliseconds(std::max(0, config.batchLockMaxWaitMs)));
+        queryTimeout = std::chrono::milliseconds(std::max(0, config.queryTimeoutMs));
+        if (config.enableMetrics) {
+            metricsStore = std::make_unique<MetricsRegistry>();
+            metrics.store(metricsStore.get(), std::memory_order_release);
+        }
+    }
+
+    ~DBContext() {
+        changeFeed.reset();   // Joins the consumer thread
+        checkpointer.reset(); // Joins the checkpoint thread and closes its connection
+
+        // Smart pointers clean up statements automatically when refcount hits 0.
+        statementCache.clear();
+        lruList.clear();
+
+        if (db) {
+            sqlite3_close(db);
+        }
+    }
+
+    std::shared_ptr<sqlite3_stmt> getStatement(const std::string& sql) {
+        auto it = statementCache.find(sql);
+        if (it != statementCache.end()) {
+            // Found! Move to front of LRU list (Mark as Recently Used)
+            lruList.erase(it->second.second);
+            lruList.push_front(sql);
+            it->second.second = lruList.begin();
+            return it->second.first;
+        }
+
+        // Not found. Check capacity.
+        if (statementCache.size() >= MAX_CACHE_SIZE) {
+            // Evict LRU (Back of list)
+            std::string lruSql = lruList.back();
+            auto cacheIt = statementCache.find(lruSql);
+            if (cacheIt != statementCache.end()) {
+                // Remove from map. Shared_ptr destructor handles finalize if it's the last ref.
+                statementCache.erase(cacheIt);
+            }
+            lruList.pop_back();
+        }
+
+        // Create new
+        sqlite3_stmt* rawStmt = nullptr;
+        if (sqlite3_prepare_v2(db, sql.c_str(), -1, &rawStmt, nullptr) != SQLITE_OK) {
+            throw std::runtime_error("Prepare failed: " + std::string(sqlite3_errmsg(db)) + " SQL: " + sql);
+        }
+        
+        // Wrap in shared_ptr with custom deleter
+        std::shared_ptr<sqlite3_stmt> stmt(rawStmt, [](sqlite3_stmt* s) {
+            sqlite3_finalize(s);
+        });
+
+        // Add to cache (Front of list)
+        lruList.push_front(sql);
+        statementCache[sql] = {stmt, lruList.begin()};
+        
+        return stmt;
+    }
+};
+
+// Applies QueryOptions::timeout / cancel (or Config::queryTimeoutMs) to one read. Built
+// after the connection lock is taken, so the budget covers running the query, not waiting
+// for the lock. When a limit applies, a progress handler polls it every PROGRESS_OPS
+// virtual machine instructions and makes sqlite3_step return SQLITE_INTERRUPT once it is
+// exceeded; reads without limits only pay for one clock read.
+class QueryBudget {
+    using Clock = std::chrono::steady_clock;
+    static constexpr int PROGRESS_OPS = 1000;
+
+    DBContext& ctx;
+    const CancellationToken* token = nullptr;
+    Clock::time_point start;
+    Clock::time_point deadline;
+    bool timed = false;
+    bool timedOut = false;
+
+    static int onProgress(void* self) {
+        auto* budget = static_cast<QueryBudget*>(self);
+        if (budget->token && budget->token->cancelled()) return 1;
+        if (budget->timed && Clock::now() >= budget->deadline) {
+            budget->timedOut = true;
+            return 1;
+        }
+        return 0;
+    }
+
+public:
+    QueryBudget(DBContext& context, const QueryOptions& opts) : ctx(context), token(opts.cancel.get()) {
+        start = Clock::now();
+        auto limit = opts.timeout.count() == 0 ? ctx.queryTimeout : opts.timeout;
+        timed = limit.count() > 0;
+        if (timed) deadline = start + limit;
+        if (timed || token) sqlite3_progress_handler(ctx.db, PROGRESS_OPS, &QueryBudget::onProgress, this);
+    }
+
+    ~QueryBudget() {
+        if (timed || token) sqlite3_progress_handler(ctx.db, 0, nullptr, nullptr);
+    }
+
+    QueryBudget(const QueryBudget&) = delete;
+    QueryBudget& operator=(const QueryBudget&) = delete;
+
+    // Call with a failed step's result code: throws QueryTimeout or QueryCancelled if the
+    // read was interrupted, after counting it in the context's CancellationStats
+    void check(int rc) {
+        if (rc != SQLITE_INTERRUPT) return;
+        uint64_t lost = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        ctx.lostNanos.fetch_add(lost, std::memory_order_relaxed);
+        uint64_t seen = ctx.maxLostNanos.load(std::memory_order_relaxed);
+        while (lost > seen && !ctx.maxLostNanos.compare_exchange_weak(seen, lost, std::memory_order_relaxed)) {}
+        std::string elapsed = std::to_string(lost / 1000000) + " ms";
+        if (timedOut) {
+            ctx.timeouts.fetch_add(1, std::memory_order_relaxed);
+            throw QueryTimeout("Query timed out after " + elapsed);
+        }
+        ctx.cancellations.fetch_add(1, std::memory_order_relaxed);
+        throw QueryCancelled("Query cancelled after " + elapsed);
+    }
+};
+
+class ScopedStmt {
+    std::shared_ptr<sqlite3_stmt> stmt;
+public:
+    ScopedStmt(std::shared_ptr<DBContext> ctx, const std::string& sql) {
+        stmt = ctx->getStatement(sql);
+    }
+
+    ~ScopedStmt() {
+        if (stmt) {
+            sqlite3_clear_bindings(stmt.get());
+            sqlite3_reset(stmt.get());
+        }
+    }
+
+    operator sqlite3_stmt*() const { return stmt.get(); }
+    sqlite3_stmt* get() const { return stmt.get(); }
+};
+
+// Runs a one-off PRAGMA / introspection / bookkeeping statement with text parameters
+// and returns its rows as text columns. Not routed through the statement cache.
+inline std::vector<std::vector<std::string>> queryText(sqlite3* db, const std::string& sql, const std::vector<std::string>& params = {}) {
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        throw std::runtime_error("Prepare failed: " + std::string(sqlite3_errmsg(db)) + " SQL: " + sql);
+    }
+    for (size_t i = 0; i < params.size(); ++i) {
+        sqlite3_bind_text(stmt, static_cast<int>(i + 1), params[i].c_str(), -1, SQLITE_TRANSIENT);
+    }
+    std::vector<std::vector<std::string>> rows;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        std::vector<std::string> row;
+        int colCount = sqlite3_column_count(stmt);
+        for (int i = 0; i < colCount; ++i) {
+            const unsigned char* text = sqlite3_column_text(stmt, i);
+            row.push_back(text ? reinterpret_cast<const char*>(text) : "");
+        }
+        rows.push_back(std::move(row));
+    }
+    if (rc != SQLITE_DONE) {
+        std::string err = sqlite3_errmsg(db);
+        sqlite3_finalize(stmt);
+        throw std::runtime_error("Query failed: " + err + " SQL: " + sql);
+    }
+    sqlite3_finalize(stmt);
+    return rows;
+}
+
+// True if every table called 'name' (in any schema, case-insensitively) is an ordinary
+// rowid table, the only kind whose writes reach the update hook. WITHOUT ROWID tables,
+// views and unknown names are not.
+inline bool isRowidTable(sqlite3* db, const std::string& name) {
+    auto rows = queryText(db, "SELECT COUNT(*), COALESCE(SUM(type = 'table' AND wr = 0), 0) "
+                              "FROM pragma_table_list WHERE name = ? COLLATE NOCASE;", {name});
+    return rows[0][0] != "0" && rows[0][0] == rows[0][1];
+}
+
+// sqlite3_exec that throws with 'what' as the message prefix
+inline void execOrThrow(sqlite3* db, const std::string& sql, const std::string& what) {
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::string err = errMsg ? errMsg : "Unknown error";
+        if (errMsg) sqlite3_free(errMsg);
+        throw std::runtime_error(what + ": " + err);
+    }
+}
+
+// Reports foreign keys of 'table' that have no index whose leftmost columns are the
+// child columns. SQLite never creates these indexes itself, so ON DELETE CASCADE
+// (and the parent-side FK check) falls back to a full scan of the child table.
+inline std::vector<UnindexedForeignKey> findUnindexedForeignKeys(sqlite3* db, const std::string& table) {
+    // PRAGMA foreign_key_list: id, seq, table, from, to, on_update, on_delete, match
+    std::map<int, UnindexedForeignKey> fks;
+    for (const auto& r : queryText(db, "PRAGMA foreign_key_list(" + quoteIdentifier(table) + ");")) {
+        auto& fk = fks[std::stoi(r[0])];
+        fk.table = table;
+        fk.refTable = r[2];
+        fk.columns.push_back(r[3]);
+    }
+    if (fks.empty()) return {};
+
+    // Leading columns of every index, plus the rowid alias which is its own b-tree key.
+    std::vector<std::vector<std::string>> indexPrefixes;
+    std::vector<std::string> pkCols;
+    std::string pkType;
+    for (const auto& r : queryText(db, "PRAGMA table_info(" + quoteIdentifier(table) + ");")) {
+        if (r[5] != "0") { pkCols.push_back(r[1]); pkType = r[2]; }
+    }
+    if (pkCols.size() == 1 && pkType == "INTEGER") indexPrefixes.push_back(pkCols);
+
+    for (const auto& idx : queryText(db, "PRAGMA index_list(" + quoteIdentifier(table) + ");")) {
+        std::vector<std::string> cols;
+        for (const auto& info : queryText(db, "PRAGMA index_info(" + quoteIdentifier(idx[1]) + ");")) {
+            cols.push_back(info[2]);
+        }
+        indexPrefixes.push_back(cols);
+    }
+
+    std::vector<UnindexedForeignKey> missing;
+    for (const auto& [id, fk] : fks) {
+        bool covered = false;
+        for (const auto& prefix : indexPrefixes) {
+            if (prefix.size() < fk.columns.size()) continue;
+            // FK columns may appear in any order, but must all be in the leading positions
+            covered = std::all_of(fk.columns.begin(), fk.columns.end(), [&](const std::string& c) {
+                return std::find(prefix.begin(), prefix.begin() + fk.columns.size(), c) != prefix.begin() + fk.columns.size();
+            });
+            if (covered) break;
+        }
+        if (!covered) missing.push_back(fk);
+    }
+    return missing;
+}
+
+// ==========================================
+// 1.5. ORM / Reflection Helpers
+// ==========================================
+
+template<typename Class, typename Member>
+struct FieldMapping {
+    Member Class::* ptr;
+    std::string name;
+};
+
+template<typename Class, typename Member>
+FieldMapping<Class, Member> orm_field(Member Class::* ptr, const std::string& name) {
+    return {ptr, name};
+}
+
+// Default generic ORM trait - users specialize this
+template<typename T>
+struct ORM {
+    // static constexpr const char* table = ...;
+    // static auto map() { return std::make_tuple(...); }
+};
+
+// Helper for type coercion from SQLValue
 template<typename T>
 T fromSQLValue(const SQLValue& val, const std::string& colName) {
     if (std::holds_alternative<T>(val)) {
@@ -329,51 +2115,1092 @@ T fromSQLValue(const SQLValue& val, const std::string& colName) {
     if constexpr (std::is_same_v<T, float>) {
         if (std::holds_alternative<double>(val)) return static_cast<float>(std::get<double>(val));
     }
-    // std::string conversion if needed (e.g. from text)
-    if constexpr (std::is_same_v<T, std::string>) {
-         // Already handled by holds_alternative, but maybe text->blob?
+    // std::string conversion if needed (e.g. from text)
+    if constexpr (std::is_same_v<T, std::string>) {
+         // Already handled by holds_alternative, but maybe text->blob?
+    }
+    
+    throw std::runtime_error("Column type mismatch for column: " + colName);
+}
+
+// Helper to coerce types TO SQLValue (for insert/update)
+template<typename T>
+SQLValue toSQLValue(const T& val) {
+    if constexpr (std::is_same_v<T, int>) return (long long)val;
+    else if constexpr (std::is_same_v<T, float>) return (double)val;
+    else return val; // rely on variant implicit constructor
+}
+
+template <typename T>
+T rowToStruct(const Row& row) {
+    T instance;
+    auto mappings = ORM<T>::map();
+    std::apply([&](const auto&... fields) {
+        ((
+            [&]{
+                auto it = row.find(fields.name);
+                if (it != row.end()) {
+                    instance.*fields.ptr = fromSQLValue<std::decay_t<decltype(instance.*fields.ptr)>>(it->second, fields.name);
+                }
+            }()
+        ), ...);
+    }, mappings);
+    return instance;
+}
+
+template <typename T>
+Row structToRow(const T& instance) {
+    Row row;
+    auto mappings = ORM<T>::map();
+    std::apply([&](const auto&... fields) {
+        ((
+            row[fields.name] = toSQLValue(instance.*fields.ptr)
+        ), ...);
+    }, mappings);
+    return row;
+}
+
+// ==========================================
+// 1.6. CSV Parsing Helpers
+// ==========================================
+
+// Offset just past the last record terminator in [data, data+size) that is not inside
+// a quoted field, or 0 if the buffer holds no complete record. 'data' must start at a
+// record boundary. Follows csvParseRecord: a quote only opens a quoted field at the start
+// of a field, anywhere else it is a literal character.
+inline size_t csvLastRecordEnd(const char* data, size_t size, char delim) {
+    bool inQuotes = false;
+    bool fieldStart = true;
+    size_t end = 0;
+    for (size_t i = 0; i < size; ++i) {
+        char c = data[i];
+        if (inQuotes) {
+            if (c != '"') continue;
+            if (i + 1 < size && data[i + 1] == '"') ++i; // Escaped quote
+            else inQuotes = false;
+        } else if (c == '"' && fieldStart) {
+            inQuotes = true;
+            fieldStart = false;
+        } else if (c == '\n') {
+            end = i + 1;
+            fieldStart = true;
+        } else {
+            fieldStart = c == delim;
+        }
+    }
+    return end;
+}
+
+// Splits one record starting at data[pos] into 'fields' and advances pos past its
+// terminator. Quoted fields have "" unescaped; 'quoted' marks which fields were quoted
+// so an unquoted empty field can be told apart from "".
+inline void csvParseRecord(const char* data, size_t size, size_t& pos, char delim,
+                           std::vector<std::string>& fields, std::vector<bool>& quoted) {
+    fields.clear();
+    quoted.clear();
+    while (true) {
+        std::string field;
+        bool isQuoted = false;
+        if (pos < size && data[pos] == '"') {
+            isQuoted = true;
+            ++pos;
+            while (pos < size) {
+                if (data[pos] == '"') {
+                    if (pos + 1 < size && data[pos + 1] == '"') { field += '"'; pos += 2; continue; }
+                    ++pos;
+                    break;
+                }
+                field += data[pos++];
+            }
+        }
+        while (pos < size && data[pos] != delim && data[pos] != '\n') field += data[pos++];
+        if (!field.empty() && field.back() == '\r' && (pos >= size || data[pos] == '\n')) field.pop_back();
+        fields.push_back(std::move(field));
+        quoted.push_back(isQuoted);
+
+        if (pos < size && data[pos] == delim) { ++pos; continue; }
+        if (pos < size) ++pos; // '\n'
+        return;
+    }
+}
+
+// Converts a CSV field to the SQLValue matching the column's declared type. Unquoted
+// empty fields become NULL; values that don't parse as the declared numeric type are
+// kept as text, the same thing SQLite's column affinity would do.
+inline SQLValue csvConvertField(std::string& field, bool quoted, SQLType type) {
+    if (field.empty()) {
+        if (!quoted) return nullptr;
+        return type == SQLType::BLOB ? SQLValue(std::vector<char>()) : SQLValue(std::string());
+    }
+    const char* first = field.data();
+    const char* last = field.data() + field.size();
+    switch (type) {
+        case SQLType::INTEGER: {
+            long long v = 0;
+            auto res = std::from_chars(first, last, v);
+            if (res.ec == std::errc() && res.ptr == last) return v;
+            break;
+        }
+        case SQLType::REAL: {
+            char* endPtr = nullptr;
+            double v = std::strtod(first, &endPtr);
+            if (endPtr == last) return v;
+            break;
+        }
+        case SQLType::BLOB:
+            return std::vector<char>(first, last);
+        default:
+            break;
+    }
+    return std::move(field);
+}
+
+// ==========================================
+// 1.7. Streaming Export Helpers
+// ==========================================
+
+// Appends a CSV field, quoted only if it contains the delimiter, a quote or a line break.
+// An empty value is written as "" because a bare empty field reads back as NULL.
+inline void csvAppendField(std::string& buf, const char* data, size_t n, char delim) {
+    bool needsQuotes = n == 0;
+    for (size_t i = 0; i < n && !needsQuotes; ++i) {
+        char c = data[i];
+        needsQuotes = c == delim || c == '"' || c == '\n' || c == '\r';
+    }
+    if (!needsQuotes) { buf.append(data, n); return; }
+    buf.push_back('"');
+    for (size_t i = 0; i < n; ++i) {
+        if (data[i] == '"') buf.push_back('"');
+        buf.push_back(data[i]);
+    }
+    buf.push_back('"');
+}
+
+// Appends a JSON string literal; UTF-8 passes through, control characters are escaped
+inline void jsonAppendString(std::string& buf, const char* data, size_t n) {
+    static const char digits[] = "0123456789abcdef";
+    buf.push_back('"');
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        switch (c) {
+            case '"':  buf.append("\\\"", 2); break;
+            case '\\': buf.append("\\\\", 2); break;
+            case '\n': buf.append("\\n", 2); break;
+            case '\r': buf.append("\\r", 2); break;
+            case '\t': buf.append("\\t", 2); break;
+            default:
+                if (c < 0x20) {
+                    char esc[6] = {'\\', 'u', '0', '0', digits[c >> 4], digits[c & 0xF]};
+                    buf.append(esc, 6);
+                } else {
+                    buf.push_back(static_cast<char>(c));
+                }
+        }
+    }
+    buf.push_back('"');
+}
+
+// Fixed-capacity output buffer flushed to a std::ostream in large blocks. Formatting
+// appends straight into it, so exporting a row does not allocate.
+class ExportBuffer {
+    std::ostream& out;
+    std::string buf;
+    size_t limit;
+public:
+    ExportBuffer(std::ostream& os, size_t bytes) : out(os), limit(std::max<size_t>(bytes, 4096)) {
+        buf.reserve(limit + 4096);
+    }
+    ~ExportBuffer() { flush(); }
+
+    void put(char c) { buf.push_back(c); }
+    void append(const char* data, size_t n) { buf.append(data, n); }
+    void append(const std::string& str) { buf.append(str); }
+    void endRecord() { if (buf.size() >= limit) flush(); }
+    void flush() {
+        if (!buf.empty()) out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+        buf.clear();
+    }
+
+    void appendInt(long long v) {
+        char tmp[24];
+        auto res = std::to_chars(tmp, tmp + sizeof(tmp), v);
+        buf.append(tmp, res.ptr);
+    }
+    // Shortest representation that round-trips
+    void appendDouble(double v) {
+        char tmp[32];
+        auto res = std::to_chars(tmp, tmp + sizeof(tmp), v);
+        buf.append(tmp, res.ptr);
+    }
+    void appendHex(const unsigned char* data, size_t n) {
+        static const char digits[] = "0123456789abcdef";
+        for (size_t i = 0; i < n; ++i) {
+            buf.push_back(digits[data[i] >> 4]);
+            buf.push_back(digits[data[i] & 0xF]);
+        }
+    }
+    void appendCsvField(const char* data, size_t n, char delim) { csvAppendField(buf, data, n, delim); }
+    void appendJsonString(const char* data, size_t n) { jsonAppendString(buf, data, n); }
+};
+
+// ==========================================
+// 1.8. Columnar Results & Arrow IPC
+// ==========================================
+
+// One result column in Arrow memory layout. 'type' is the SQLType the column was
+// materialized as; it stays NULL_VAL only when every value was NULL.
+struct ColumnarColumn {
+    std::string name;
+    SQLType type = SQLType::NULL_VAL;
+    size_t nullCount = 0;
+    std::vector<uint8_t> validity;  // Bit i (LSB first) set when row i is not NULL
+    std::vector<int64_t> ints;      // INTEGER values (0 in NULL slots)
+    std::vector<double> doubles;    // REAL values (0 in NULL slots)
+    std::vector<int32_t> offsets;   // TEXT/BLOB: rows + 1 offsets into 'bytes'
+    std::vector<char> bytes;        // TEXT/BLOB: concatenated values
+
+    bool isNull(size_t row) const { return !(validity[row >> 3] & (1u << (row & 7))); }
+
+    std::string_view text(size_t row) const {
+        return std::string_view(bytes.data() + offsets[row], static_cast<size_t>(offsets[row + 1] - offsets[row]));
+    }
+};
+
+struct ColumnarResult {
+    size_t rows = 0;
+    std::vector<ColumnarColumn> columns;
+
+    const ColumnarColumn& column(const std::string& name) const {
+        for (const auto& c : columns) {
+            if (c.name == name) return c;
+        }
+        throw std::runtime_error("Column not found: " + name);
+    }
+
+    // Writes the result as an Arrow IPC stream: Schema message, one RecordBatch, EOS.
+    void writeArrowIpc(std::ostream& out) const;
+};
+
+// Minimal FlatBuffers builder, just enough for Arrow's Schema/RecordBatch metadata.
+// Like the reference builder it fills the buffer back to front, so children are
+// created before the tables that point at them; offsets are distances from the end.
+class FlatBuilder {
+    std::vector<uint8_t> buf; // Final layout; prepended to
+    size_t minAlign = 1;
+    size_t tableStart = 0;
+    std::vector<std::pair<uint16_t, uint32_t>> fields; // slot, offset of the field
+
+    void prepend(const void* data, size_t n) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        buf.insert(buf.begin(), p, p + n);
+    }
+    // Pads so that after writing 'extra' more bytes the front is aligned to 'a'
+    void align(size_t a, size_t extra = 0) {
+        minAlign = std::max(minAlign, a);
+        while ((buf.size() + extra) % a) buf.insert(buf.begin(), 0);
+    }
+    template<typename T>
+    void push(T v) {
+        align(sizeof(T));
+        prepend(&v, sizeof(T)); // Little-endian hosts only, as is Arrow's default
+    }
+    void pushOffset(uint32_t target) {
+        align(4);
+        uint32_t rel = static_cast<uint32_t>(buf.size() + 4 - target);
+        prepend(&rel, 4);
+    }
+
+public:
+    uint32_t createString(const std::string& str) {
+        align(4, str.size() + 1);
+        buf.insert(buf.begin(), 0);
+        prepend(str.data(), str.size());
+        push(static_cast<uint32_t>(str.size()));
+        return static_cast<uint32_t>(buf.size());
+    }
+
+    uint32_t createOffsetVector(const std::vector<uint32_t>& targets) {
+        align(4, targets.size() * 4);
+        for (auto it = targets.rbegin(); it != targets.rend(); ++it) pushOffset(*it);
+        push(static_cast<uint32_t>(targets.size()));
+        return static_cast<uint32_t>(buf.size());
+    }
+
+    // Vector of structs made of two int64 fields (Arrow FieldNode and Buffer)
+    uint32_t createPairVector(const std::vector<std::pair<int64_t, int64_t>>& items) {
+        align(4, items.size() * 16);
+        align(8, items.size() * 16);
+        for (auto it = items.rbegin(); it != items.rend(); ++it) {
+            prepend(&it->second, 8);
+            prepend(&it->first, 8);
+        }
+        push(static_cast<uint32_t>(items.size()));
+        return static_cast<uint32_t>(buf.size());
+    }
+
+    void startTable() {
+        fields.clear();
+        tableStart = buf.size();
+    }
+    template<typename T>
+    void addScalar(uint16_t slot, T v) {
+        push(v);
+        fields.emplace_back(slot, static_cast<uint32_t>(buf.size()));
+    }
+    void addOffset(uint16_t slot, uint32_t target) {
+        pushOffset(target);
+        fields.emplace_back(slot, static_cast<uint32_t>(buf.size()));
+    }
+    uint32_t endTable() {
+        uint16_t slots = 0;
+        for (const auto& f : fields) slots = std::max<uint16_t>(slots, f.first + 1);
+        uint16_t vtableSize = static_cast<uint16_t>(4 + 2 * slots);
+
+        // The vtable goes directly in front of the table, so the table's soffset to it
+        // is just the vtable size
+        push(static_cast<int32_t>(vtableSize));
+        uint32_t table = static_cast<uint32_t>(buf.size());
+        uint16_t objectSize = static_cast<uint16_t>(table - tableStart);
+        for (int slot = slots - 1; slot >= 0; --slot) {
+            uint16_t fieldOffset = 0;
+            for (const auto& f : fields) {
+                if (f.first == slot) fieldOffset = static_cast<uint16_t>(table - f.second);
+            }
+            prepend(&fieldOffset, 2);
+        }
+        prepend(&objectSize, 2);
+        prepend(&vtableSize, 2);
+        return table;
+    }
+
+    std::vector<uint8_t> finish(uint32_t root) {
+        align(std::max<size_t>(minAlign, 8), 4);
+        pushOffset(root);
+        return buf;
+    }
+};
+
+// Arrow IPC metadata enums (Schema.fbs / Message.fbs)
+enum ArrowMessageHeader : uint8_t { ARROW_SCHEMA = 1, ARROW_RECORD_BATCH = 3 };
+enum ArrowTypeId : uint8_t { ARROW_NULL = 1, ARROW_INT = 2, ARROW_FLOAT = 3, ARROW_BINARY = 4, ARROW_UTF8 = 5 };
+
+// Encapsulated message: continuation marker, metadata length, metadata padded to 8, body
+inline void arrowWriteMessage(std::ostream& out, const std::vector<uint8_t>& meta, const std::string& body) {
+    static const char zeros[8] = {};
+    size_t padded = (meta.size() + 7) & ~size_t(7);
+    int32_t header[2] = {-1, static_cast<int32_t>(padded)};
+    out.write(reinterpret_cast<const char*>(header), 8);
+    out.write(reinterpret_cast<const char*>(meta.data()), static_cast<std::streamsize>(meta.size()));
+    out.write(zeros, static_cast<std::streamsize>(padded - meta.size()));
+    out.write(body.data(), static_cast<std::streamsize>(body.size()));
+}
+
+inline std::vector<uint8_t> arrowMessage(FlatBuilder& fb, ArrowMessageHeader type, uint32_t header, int64_t bodyLength) {
+    fb.startTable();
+    fb.addScalar<int64_t>(3, bodyLength);  // bodyLength
+    fb.addOffset(2, header);               // header
+    fb.addScalar<int16_t>(0, 4);           // version = V5
+    fb.addScalar<uint8_t>(1, type);        // header_type
+    return fb.finish(fb.endTable());
+}
+
+inline void ColumnarResult::writeArrowIpc(std::ostream& out) const {
+    // Schema
+    {
+        FlatBuilder fb;
+        std::vector<uint32_t> fieldOffsets;
+        for (const auto& col : columns) {
+            uint8_t typeId = ARROW_NULL;
+            fb.startTable();
+            switch (col.type) {
+                case SQLType::INTEGER:
+                    typeId = ARROW_INT;
+                    fb.addScalar<int32_t>(0, 64);  // bitWidth
+                    fb.addScalar<uint8_t>(1, 1);   // is_signed
+                    break;
+                case SQLType::REAL:
+                    typeId = ARROW_FLOAT;
+                    fb.addScalar<int16_t>(0, 2);   // precision = DOUBLE
+                    break;
+                case SQLType::TEXT: typeId = ARROW_UTF8; break;
+                case SQLType::BLOB: typeId = ARROW_BINARY; break;
+                default: break;
+            }
+            uint32_t type = fb.endTable();
+            uint32_t name = fb.createString(col.name);
+            uint32_t children = fb.createOffsetVector({});
+
+            fb.startTable();
+            fb.addOffset(0, name);
+            fb.addOffset(3, type);
+            fb.addOffset(5, children);
+            fb.addScalar<uint8_t>(1, 1);           // nullable
+            fb.addScalar<uint8_t>(2, typeId);      // type_type
+            fieldOffsets.push_back(fb.endTable());
+        }
+        uint32_t fieldVec = fb.createOffsetVector(fieldOffsets);
+        fb.startTable();
+        fb.addOffset(1, fieldVec);
+        fb.addScalar<int16_t>(0, 0);               // endianness = Little
+        uint32_t schema = fb.endTable();
+        arrowWriteMessage(out, arrowMessage(fb, ARROW_SCHEMA, schema, 0), std::string());
+    }
+
+    // Record batch: buffers laid out back to back in the body, each padded to 8 bytes
+    {
+        std::string body;
+        std::vector<std::pair<int64_t, int64_t>> nodes;
+        std::vector<std::pair<int64_t, int64_t>> buffers;
+        auto addBuffer = [&](const void* data, size_t n) {
+            buffers.emplace_back(static_cast<int64_t>(body.size()), static_cast<int64_t>(n));
+            body.append(static_cast<const char*>(data), n);
+            body.append((8 - body.size() % 8) % 8, '\0');
+        };
+        for (const auto& col : columns) {
+            nodes.emplace_back(static_cast<int64_t>(rows), static_cast<int64_t>(col.type == SQLType::NULL_VAL ? rows : col.nullCount));
+            if (col.type == SQLType::NULL_VAL) continue; // Null arrays have no buffers
+            if (col.nullCount > 0) addBuffer(col.validity.data(), (rows + 7) / 8);
+            else addBuffer(nullptr, 0);
+            switch (col.type) {
+                case SQLType::INTEGER: addBuffer(col.ints.data(), rows * sizeof(int64_t)); break;
+                case SQLType::REAL:    addBuffer(col.doubles.data(), rows * sizeof(double)); break;
+                default:
+                    addBuffer(col.offsets.data(), (rows + 1) * sizeof(int32_t));
+                    addBuffer(col.bytes.data(), col.bytes.size());
+                    break;
+            }
+        }
+
+        FlatBuilder fb;
+        uint32_t bufferVec = fb.createPairVector(buffers);
+        uint32_t nodeVec = fb.createPairVector(nodes);
+        fb.startTable();
+        fb.addScalar<int64_t>(0, static_cast<int64_t>(rows)); // length
+        fb.addOffset(1, nodeVec);
+        fb.addOffset(2, bufferVec);
+        uint32_t batch = fb.endTable();
+        arrowWriteMessage(out, arrowMessage(fb, ARROW_RECORD_BATCH, batch, static_cast<int64_t>(body.size())), body);
+    }
+
+    // End-of-stream marker
+    int32_t eos[2] = {-1, 0};
+    out.write(reinterpret_cast<const char*>(eos), 8);
+}
+
+// ==========================================
+// 1.9. Column Kernels
+// ==========================================
+
+// Reductions over contiguous numeric buffers (Table::column, ColumnarColumn). Sum and
+// min/max use AVX2 when the translation unit is compiled with it (SQLDB_AVX2 / -mavx2 /
+// /arch:AVX2), SSE2 otherwise on x86-64, and unrolled scalar loops elsewhere. The one
+// exception is int64 min/max: SSE2 has no 64-bit compare, so without AVX2 it needs
+// SSE4.2 (-msse4.2) and is a scalar loop otherwise. Histogram, count and filter use SSE2
+// for doubles and branch-free loops otherwise. Vector sums add
+// in a different order than a plain loop, so double results can differ in the last bits.
+// SQLite stores NaN as NULL, so inputs read from the database never contain NaN.
+
+inline double columnSum(const double* data, size_t n) {
+    size_t i = 0;
+    double total = 0.0;
+#if SQLDB_SIMD_AVX2
+    __m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd(), a2 = _mm256_setzero_pd(), a3 = _mm256_setzero_pd();
+    for (; i + 16 <= n; i += 16) {
+        a0 = _mm256_add_pd(a0, _mm256_loadu_pd(data + i));
+        a1 = _mm256_add_pd(a1, _mm256_loadu_pd(data + i + 4));
+        a2 = _mm256_add_pd(a2, _mm256_loadu_pd(data + i + 8));
+        a3 = _mm256_add_pd(a3, _mm256_loadu_pd(data + i + 12));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(_mm256_add_pd(a0, a1), _mm256_add_pd(a2, a3)));
+    total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif SQLDB_SIMD_SSE2
+    __m128d a0 = _mm_setzero_pd(), a1 = _mm_setzero_pd(), a2 = _mm_setzero_pd(), a3 = _mm_setzero_pd();
+    for (; i + 8 <= n; i += 8) {
+        a0 = _mm_add_pd(a0, _mm_loadu_pd(data + i));
+        a1 = _mm_add_pd(a1, _mm_loadu_pd(data + i + 2));
+        a2 = _mm_add_pd(a2, _mm_loadu_pd(data + i + 4));
+        a3 = _mm_add_pd(a3, _mm_loadu_pd(data + i + 6));
+    }
+    alignas(16) double lanes[2];
+    _mm_store_pd(lanes, _mm_add_pd(_mm_add_pd(a0, a1), _mm_add_pd(a2, a3)));
+    total = lanes[0] + lanes[1];
+#else
+    double a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+    for (; i + 4 <= n; i += 4) {
+        a0 += data[i]; a1 += data[i + 1]; a2 += data[i + 2]; a3 += data[i + 3];
+    }
+    total = (a0 + a1) + (a2 + a3);
+#endif
+    for (; i < n; ++i) total += data[i];
+    return total;
+}
+
+// Wraps on overflow, like unsigned arithmetic
+inline int64_t columnSum(const int64_t* data, size_t n) {
+    size_t i = 0;
+    uint64_t total = 0;
+#if SQLDB_SIMD_AVX2
+    __m256i a0 = _mm256_setzero_si256(), a1 = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8) {
+        a0 = _mm256_add_epi64(a0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+        a1 = _mm256_add_epi64(a1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 4)));
+    }
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(a0, a1));
+    total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif SQLDB_SIMD_SSE2
+    __m128i a0 = _mm_setzero_si128(), a1 = _mm_setzero_si128();
+    for (; i + 4 <= n; i += 4) {
+        a0 = _mm_add_epi64(a0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+        a1 = _mm_add_epi64(a1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 2)));
+    }
+    alignas(16) uint64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_add_epi64(a0, a1));
+    total = lanes[0] + lanes[1];
+#endif
+    for (; i < n; ++i) total += static_cast<uint64_t>(data[i]);
+    return static_cast<int64_t>(total);
+}
+
+// {min, max}; throws on empty input
+inline std::pair<double, double> columnMinMax(const double* data, size_t n) {
+    if (n == 0) throw std::runtime_error("columnMinMax: empty column");
+    size_t i = 0;
+    double lo = data[0], hi = data[0];
+#if SQLDB_SIMD_AVX2
+    if (n >= 8) {
+        __m256d mn0 = _mm256_loadu_pd(data), mx0 = mn0;
+        __m256d mn1 = _mm256_loadu_pd(data + 4), mx1 = mn1;
+        for (i = 8; i + 8 <= n; i += 8) {
+            __m256d v0 = _mm256_loadu_pd(data + i), v1 = _mm256_loadu_pd(data + i + 4);
+            mn0 = _mm256_min_pd(mn0, v0); mx0 = _mm256_max_pd(mx0, v0);
+            mn1 = _mm256_min_pd(mn1, v1); mx1 = _mm256_max_pd(mx1, v1);
+        }
+        alignas(32) double a[4], b[4];
+        _mm256_store_pd(a, _mm256_min_pd(mn0, mn1));
+        _mm256_store_pd(b, _mm256_max_pd(mx0, mx1));
+        lo = std::min(std::min(a[0], a[1]), std::min(a[2], a[3]));
+        hi = std::max(std::max(b[0], b[1]), std::max(b[2], b[3]));
+    }
+#elif SQLDB_SIMD_SSE2
+    if (n >= 4) {
+        __m128d mn0 = _mm_loadu_pd(data), mx0 = mn0;
+        __m128d mn1 = _mm_loadu_pd(data + 2), mx1 = mn1;
+        for (i = 4; i + 4 <= n; i += 4) {
+            __m128d v0 = _mm_loadu_pd(data + i), v1 = _mm_loadu_pd(data + i + 2);
+            mn0 = _mm_min_pd(mn0, v0); mx0 = _mm_max_pd(mx0, v0);
+            mn1 = _mm_min_pd(mn1, v1); mx1 = _mm_max_pd(mx1, v1);
+        }
+        alignas(16) double a[2], b[2];
+        _mm_store_pd(a, _mm_min_pd(mn0, mn1));
+        _mm_store_pd(b, _mm_max_pd(mx0, mx1));
+        lo = std::min(a[0], a[1]);
+        hi = std::max(b[0], b[1]);
+    }
+#endif
+    for (; i < n; ++i) {
+        lo = std::min(lo, data[i]);
+        hi = std::max(hi, data[i]);
+    }
+    return {lo, hi};
+}
+
+inline std::pair<int64_t, int64_t> columnMinMax(const int64_t* data, size_t n) {
+    if (n == 0) throw std::runtime_error("columnMinMax: empty column");
+    size_t i = 0;
+    int64_t lo = data[0], hi = data[0];
+#if SQLDB_SIMD_AVX2
+    // No 64-bit integer min/max before AVX-512: compare and blend
+    if (n >= 4) {
+        __m256i mn = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)), mx = mn;
+        for (i = 4; i + 4 <= n; i += 4) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            mn = _mm256_blendv_epi8(mn, v, _mm256_cmpgt_epi64(mn, v));
+            mx = _mm256_blendv_epi8(mx, v, _mm256_cmpgt_epi64(v, mx));
+        }
+        alignas(32) int64_t a[4], b[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(a), mn);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(b), mx);
+        lo = std::min(std::min(a[0], a[1]), std::min(a[2], a[3]));
+        hi = std::max(std::max(b[0], b[1]), std::max(b[2], b[3]));
+    }
+#elif SQLDB_SIMD_SSE42
+    if (n >= 4) {
+        const __m128i* p = reinterpret_cast<const __m128i*>(data);
+        __m128i mn0 = _mm_loadu_si128(p), mx0 = mn0;
+        __m128i mn1 = _mm_loadu_si128(p + 1), mx1 = mn1;
+        for (i = 4; i + 4 <= n; i += 4) {
+            __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 2));
+            mn0 = _mm_blendv_epi8(mn0, v0, _mm_cmpgt_epi64(mn0, v0));
+            mx0 = _mm_blendv_epi8(mx0, v0, _mm_cmpgt_epi64(v0, mx0));
+            mn1 = _mm_blendv_epi8(mn1, v1, _mm_cmpgt_epi64(mn1, v1));
+            mx1 = _mm_blendv_epi8(mx1, v1, _mm_cmpgt_epi64(v1, mx1));
+        }
+        alignas(16) int64_t a[4], b[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(a), mn0);
+        _mm_store_si128(reinterpret_cast<__m128i*>(a + 2), mn1);
+        _mm_store_si128(reinterpret_cast<__m128i*>(b), mx0);
+        _mm_store_si128(reinterpret_cast<__m128i*>(b + 2), mx1);
+        lo = std::min(std::min(a[0], a[1]), std::min(a[2], a[3]));
+        hi = std::max(std::max(b[0], b[1]), std::max(b[2], b[3]));
+    }
+#else
+    int64_t lo1 = lo, hi1 = hi;
+    for (i = 1; i + 2 <= n; i += 2) {
+        lo = std::min(lo, data[i]);  hi = std::max(hi, data[i]);
+        lo1 = std::min(lo1, data[i + 1]); hi1 = std::max(hi1, data[i + 1]);
+    }
+    lo = std::min(lo, lo1);
+    hi = std::max(hi, hi1);
+#endif
+    for (; i < n; ++i) {
+        lo = std::min(lo, data[i]);
+        hi = std::max(hi, data[i]);
+    }
+    return {lo, hi};
+}
+
+// Counts values into 'bins' equal-width buckets over [lo, hi]; values equal to hi land
+// in the last bucket and values outside the range are not counted.
+template<typename T>
+std::vector<size_t> columnHistogram(const T* data, size_t n, double lo, double hi, size_t bins) {
+    std::vector<size_t> counts(bins, 0);
+    if (bins == 0 || !(hi > lo)) return counts;
+    if (bins > static_cast<size_t>(INT32_MAX - 1)) throw std::runtime_error("columnHistogram: too many bins");
+    // Bucket indices are computed a block at a time (two per instruction for doubles),
+    // with out-of-range values sent to a spare bucket instead of branching. They are then
+    // counted into four interleaved tables so that runs of equal indices do not wait on
+    // each other's increments.
+    const double scale = bins / (hi - lo);
+    const double top = static_cast<double>(bins - 1);
+    const size_t stride = bins + 1;
+    std::vector<size_t> tables(4 * stride, 0);
+    size_t* t0 = tables.data();
+    size_t* t1 = t0 + stride;
+    size_t* t2 = t1 + stride;
+    size_t* t3 = t2 + stride;
+    auto bucket = [&](double v) {
+        double f = std::min((v - lo) * scale, top);
+        return (v >= lo && v <= hi) ? static_cast<int32_t>(f) : static_cast<int32_t>(bins);
+    };
+    const size_t BLOCK = 256;
+    alignas(16) int32_t idx[BLOCK];
+    for (size_t base = 0; base < n; base += BLOCK) {
+        const size_t m = std::min(BLOCK, n - base);
+        const T* block = data + base;
+        size_t j = 0;
+#if SQLDB_SIMD_AVX2 || SQLDB_SIMD_SSE2
+        if constexpr (std::is_same_v<T, double>) {
+            const __m128d vlo = _mm_set1_pd(lo), vhi = _mm_set1_pd(hi), vscale = _mm_set1_pd(scale);
+            const __m128d vtop = _mm_set1_pd(top), vspare = _mm_set1_pd(static_cast<double>(bins));
+            for (; j + 2 <= m; j += 2) {
+                __m128d v = _mm_loadu_pd(block + j);
+                __m128d f = _mm_min_pd(_mm_mul_pd(_mm_sub_pd(v, vlo), vscale), vtop);
+                __m128d in = _mm_and_pd(_mm_cmpge_pd(v, vlo), _mm_cmple_pd(v, vhi));
+                f = _mm_or_pd(_mm_and_pd(in, f), _mm_andnot_pd(in, vspare));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(idx + j), _mm_cvttpd_epi32(f));
+            }
+        }
+#endif
+        for (; j < m; ++j) idx[j] = bucket(static_cast<double>(block[j]));
+        for (j = 0; j + 4 <= m; j += 4) {
+            ++t0[idx[j]]; ++t1[idx[j + 1]]; ++t2[idx[j + 2]]; ++t3[idx[j + 3]];
+        }
+        for (; j < m; ++j) ++t0[idx[j]];
+    }
+    for (size_t b = 0; b < bins; ++b) counts[b] = t0[b] + t1[b] + t2[b] + t3[b];
+    return counts;
+}
+
+// Calls fn with a predicate for "x <op> value". LIKE is not meaningful for numbers and
+// throws.
+template<typename T, typename Fn>
+auto columnPredicate(Op op, T value, Fn&& fn) {
+    switch (op) {
+        case Op::EQ:  return fn([value](T x) { return x == value; });
+        case Op::NEQ: return fn([value](T x) { return x != value; });
+        case Op::GT:  return fn([value](T x) { return x > value; });
+        case Op::LT:  return fn([value](T x) { return x < value; });
+        default: throw std::runtime_error("Column kernels: unsupported operator");
+    }
+}
+
+#if SQLDB_SIMD_AVX2 || SQLDB_SIMD_SSE2
+// columnPredicate for two doubles at a time: fn gets a compare returning an all-ones lane
+// per match
+template<typename Fn>
+auto columnPredicatePd(Op op, double value, Fn&& fn) {
+    const __m128d v = _mm_set1_pd(value);
+    switch (op) {
+        case Op::EQ:  return fn([v](__m128d x) { return _mm_cmpeq_pd(x, v); });
+        case Op::NEQ: return fn([v](__m128d x) { return _mm_cmpneq_pd(x, v); });
+        case Op::GT:  return fn([v](__m128d x) { return _mm_cmpgt_pd(x, v); });
+        case Op::LT:  return fn([v](__m128d x) { return _mm_cmplt_pd(x, v); });
+        default: throw std::runtime_error("Column kernels: unsupported operator");
     }
-    
-    throw std::runtime_error("Column type mismatch for column: " + colName);
 }
+#endif
 
-// Helper to coerce types TO SQLValue (for insert/update)
+// Number of elements with data[i] <op> value
 template<typename T>
-SQLValue toSQLValue(const T& val) {
-    if constexpr (std::is_same_v<T, int>) return (long long)val;
-    else if constexpr (std::is_same_v<T, float>) return (double)val;
-    else return val; // rely on variant implicit constructor
+size_t columnCount(const T* data, size_t n, Op op, typename std::common_type<T>::type value) {
+#if SQLDB_SIMD_AVX2 || SQLDB_SIMD_SSE2
+    if constexpr (std::is_same_v<T, double>) {
+        return columnPredicatePd(op, value, [&](auto compare) {
+            // A matching lane is -1, so subtracting it counts
+            __m128i acc = _mm_setzero_si128();
+            size_t i = 0;
+            for (; i + 2 <= n; i += 2) acc = _mm_sub_epi64(acc, _mm_castpd_si128(compare(_mm_loadu_pd(data + i))));
+            alignas(16) uint64_t lanes[2];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+            size_t k = static_cast<size_t>(lanes[0] + lanes[1]);
+            if (i < n) k += _mm_movemask_pd(compare(_mm_load_sd(data + i))) & 1;
+            return k;
+        });
+    }
+#endif
+    return columnPredicate<T>(op, value, [&](auto match) {
+        size_t k = 0;
+        // One comparison per element, no branch; compilers vectorize this
+        for (size_t i = 0; i < n; ++i) k += match(data[i]);
+        return k;
+    });
 }
 
-template <typename T>
-T rowToStruct(const Row& row) {
-    T instance;
-    auto mappings = ORM<T>::map();
-    std::apply([&](const auto&... fields) {
-        ((
-            [&]{
-                auto it = row.find(fields.name);
-                if (it != row.end()) {
-                    instance.*fields.ptr = fromSQLValue<std::decay_t<decltype(instance.*fields.ptr)>>(it->second, fields.name);
+// The elements with data[i] <op> value, in order. Counts the matches first so the result
+// is allocated once at its final size, then compacts without a branch per element.
+template<typename T>
+std::vector<T> columnFilter(const T* data, size_t n, Op op, typename std::common_type<T>::type value) {
+    std::vector<T> out(columnCount(data, n, op, value) + 1); // One spare slot for unconditional stores
+    T* o = out.data();
+    size_t k = 0, i = 0;
+#if SQLDB_SIMD_AVX2 || SQLDB_SIMD_SSE2
+    if constexpr (std::is_same_v<T, double>) {
+        i = columnPredicatePd(op, value, [&](auto compare) {
+            size_t j = 0;
+            // Four values per step: skip a block without matches, copy a block of all
+            // matches, otherwise store every value and advance past the matching ones
+            for (; j + 4 <= n; j += 4) {
+                __m128d a = _mm_loadu_pd(data + j), b = _mm_loadu_pd(data + j + 2);
+                int mask = _mm_movemask_pd(compare(a)) | (_mm_movemask_pd(compare(b)) << 2);
+                if (mask == 0) continue;
+                if (mask == 15) {
+                    _mm_storeu_pd(o + k, a);
+                    _mm_storeu_pd(o + k + 2, b);
+                    k += 4;
+                    continue;
                 }
-            }()
-        ), ...);
-    }, mappings);
-    return instance;
+                o[k] = data[j];     k += mask & 1;
+                o[k] = data[j + 1]; k += (mask >> 1) & 1;
+                o[k] = data[j + 2]; k += (mask >> 2) & 1;
+                o[k] = data[j + 3]; k += mask >> 3;
+            }
+            return j;
+        });
+    }
+#endif
+    columnPredicate<T>(op, value, [&](auto match) {
+        for (; i < n; ++i) {
+            o[k] = data[i];
+            k += match(data[i]);
+        }
+        return 0;
+    });
+    out.pop_back();
+    return out;
 }
 
-template <typename T>
-Row structToRow(const T& instance) {
-    Row row;
-    auto mappings = ORM<T>::map();
-    std::apply([&](const auto&... fields) {
-        ((
-            row[fields.name] = toSQLValue(instance.*fields.ptr)
-        ), ...);
-    }, mappings);
-    return row;
+// p in [0, 1], nearest-rank on a copy (the input is left untouched): the smallest value
+// with at least p * n values at or below it, the minimum for p = 0
+template<typename T>
+T columnPercentile(const T* data, size_t n, double p) {
+    if (n == 0) throw std::runtime_error("columnPercentile: empty column");
+    std::vector<T> tmp(data, data + n);
+    // Shrunk by a few ulps so that e.g. 0.07 * 100, which rounds to 7.000000000000001,
+    // is rank 7 and not 8
+    double rank = std::ceil(std::min(std::max(p, 0.0), 1.0) * n * (1.0 - 4 * std::numeric_limits<double>::epsilon()));
+    size_t k = rank < 1.0 ? 0 : static_cast<size_t>(rank) - 1;
+    std::nth_element(tmp.begin(), tmp.begin() + k, tmp.end());
+    return tmp[k];
 }
 
+// std::vector conveniences
+template<typename T> auto columnSum(const std::vector<T>& v) { return columnSum(v.data(), v.size()); }
+template<typename T> auto columnMinMax(const std::vector<T>& v) { return columnMinMax(v.data(), v.size()); }
+template<typename T> std::vector<size_t> columnHistogram(const std::vector<T>& v, double lo, double hi, size_t bins) { return columnHistogram(v.data(), v.size(), lo, hi, bins); }
+template<typename T> size_t columnCount(const std::vector<T>& v, Op op, typename std::common_type<T>::type value) { return columnCount(v.data(), v.size(), op, value); }
+template<typename T> std::vector<T> columnFilter(const std::vector<T>& v, Op op, typename std::common_type<T>::type value) { return columnFilter(v.data(), v.size(), op, value); }
+template<typename T> T columnPercentile(const std::vector<T>& v, double p) { return columnPercentile(v.data(), v.size(), p); }
+
+// ==========================================
+// 1.10. Row Cache
+// ==========================================
+
+// Size-bounded, sharded LRU of rows keyed by rowid (Table::enableRowCache). Each shard
+// has its own mutex so cache hits from different threads don't contend on DBContext::mtx.
+class RowCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t invalidations = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    RowCache(size_t maxBytes, size_t shardCount) {
+        shardCount = std::max<size_t>(1, shardCount);
+        maxShardBytes = std::max<size_t>(1, maxBytes / shardCount);
+        for (size_t i = 0; i < shardCount; ++i) shards.push_back(std::make_unique<Shard>());
+    }
+
+    std::optional<Row> get(long long key) {
+        Shard& sh = shardFor(key);
+        std::lock_guard<std::mutex> lock(sh.mtx);
+        auto it = sh.index.find(key);
+        if (it == sh.index.end()) {
+            ++sh.misses;
+            return std::nullopt;
+        }
+        sh.lru.splice(sh.lru.begin(), sh.lru, it->second);
+        ++sh.hits;
+        return it->second->row;
+    }
+
+    void put(long long key, const Row& row) {
+        Shard& sh = shardFor(key);
+        std::lock_guard<std::mutex> lock(sh.mtx);
+        eraseLocked(sh, key);
+        size_t bytes = sizeof(Entry) + approxRowBytes(row);
+        if (bytes > maxShardBytes) return;
+        sh.lru.push_front({key, row, bytes});
+        sh.index[key] = sh.lru.begin();
+        sh.bytes += bytes;
+        while (sh.bytes > maxShardBytes) {
+            auto& victim = sh.lru.back();
+            sh.bytes -= victim.bytes;
+            sh.index.erase(victim.key);
+            sh.lru.pop_back();
+            ++sh.evictions;
+        }
+    }
+
+    void invalidate(long long key) {
+        Shard& sh = shardFor(key);
+        std::lock_guard<std::mutex> lock(sh.mtx);
+        if (eraseLocked(sh, key)) ++sh.invalidations;
+    }
+
+    void clear() {
+        for (auto& sh : shards) {
+            std::lock_guard<std::mutex> lock(sh->mtx);
+            sh->invalidations += sh->index.size();
+            sh->lru.clear();
+            sh->index.clear();
+            sh->bytes = 0;
+        }
+    }
+
+    Stats stats() const {
+        Stats st;
+        for (const auto& sh : shards) {
+            std::lock_guard<std::mutex> lock(sh->mtx);
+            st.hits += sh->hits;
+            st.misses += sh->misses;
+            st.evictions += sh->evictions;
+            st.invalidations += sh->invalidations;
+            st.entries += sh->index.size();
+            st.bytes += sh->bytes;
+        }
+        return st;
+    }
+
+private:
+    struct Entry {
+        long long key;
+        Row row;
+        size_t bytes;
+    };
+    struct Shard {
+        mutable std::mutex mtx;
+        std::list<Entry> lru; // Front = MRU
+        std::unordered_map<long long, std::list<Entry>::iterator> index;
+        size_t bytes = 0;
+        uint64_t hits = 0, misses = 0, evictions = 0, invalidations = 0;
+    };
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t maxShardBytes = 0;
+
+    Shard& shardFor(long long key) {
+        // Fibonacci hashing spreads sequential ids across shards
+        uint64_t h = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull;
+        return *shards[(h >> 32) % shards.size()];
+    }
+
+    bool eraseLocked(Shard& sh, long long key) {
+        auto it = sh.index.find(key);
+        if (it == sh.index.end()) return false;
+        sh.bytes -= it->second->bytes;
+        sh.lru.erase(it->second);
+        sh.index.erase(it);
+        return true;
+    }
+};
+
+// ==========================================
+// 1.11. Live Queries
+// ==========================================
+
+// A query kept up to date in the background (Table::watch). A hook listener notes
+// commits that wrote any of the query's tables; a worker thread waits out the debounce
+// interval, re-runs the query, diffs the result against the previous one by key, and
+// passes non-empty deltas to the callback. Stopping (or destroying) the handle removes
+// the listener and joins the worker.
+class LiveQuery {
+public:
+    using Callback = std::function<void(const WatchDelta&)>;
+
+    // Runs 'query' once and delivers the full result as 'added' on the calling thread.
+    // 'tables' are the lowercased names the query reads.
+    LiveQuery(std::shared_ptr<DBContext> context, std::vector<std::string> tables, std::vector<std::string> keyColumns,
+              std::function<std::vector<Row>()> query, Callback callback, std::chrono::milliseconds debounce)
+        : ctx(std::move(context)), deps(tables.begin(), tables.end()), key(std::move(keyColumns)),
+          run(std::move(query)), cb(std::move(callback)), debounce(debounce) {
+        {
+            // Listen before the first run so a commit in between triggers a refresh
+            ContextLock lock(ctx->mtx, "LiveQuery::LiveQuery");
+            DBContext::HookListener listener;
+            listener.onUpdate = [this](int, const char* table, sqlite3_int64) {
+                if (deps.count(asciiLower(table))) touched = true;
+            };
+            listener.onCommit = [this]() {
+                if (!touched) return;
+                touched = false;
+                std::lock_guard<std::mutex> lock(stateMtx);
+                dirty = true;
+                cv.notify_one();
+            };
+            listener.onRollback = [this]() { touched = false; };
+            listenerId = ctx->addHookListener(std::move(listener));
+            for (const auto& t : deps) ctx->trackDeletes(t);
+        }
+        try {
+            WatchDelta initial;
+            for (auto& row : run()) {
+                std::string k = rowKey(row);
+                initial.added.push_back(row);
+                snapshot.emplace(std::move(k), std::move(row));
+            }
+            cb(initial);
+        } catch (...) {
+            detach();
+            throw;
+        }
+        worker = std::thread([this] { loop(); });
+    }
+
+    ~LiveQuery() { stop(); }
+
+    LiveQuery(const LiveQuery&) = delete;
+    LiveQuery& operator=(const LiveQuery&) = delete;
+
+    // Must not be called from the callback
+    void stop() {
+        detach();
+        {
+            std::lock_guard<std::mutex> lock(stateMtx);
+            stopping = true;
+        }
+        cv.notify_one();
+        if (worker.joinable()) worker.join();
+    }
+
+    uint64_t refreshes() const { return refreshCount.load(); }  // Re-executions
+    uint64_t deliveries() const { return deliveryCount.load(); } // Non-empty deltas delivered
+
+private:
+    std::shared_ptr<DBContext> ctx;
+    std::unordered_set<std::string> deps;
+    std::vector<std::string> key;
+    std::function<std::vector<Row>()> run;
+    Callback cb;
+    std::chrono::milliseconds debounce;
+
+    size_t listenerId = 0;            // DBContext::mtx
+    bool touched = false;             // DBContext::mtx: current transaction wrote a dependency
+    std::mutex stateMtx;
+    std::condition_variable cv;
+    bool dirty = false;               // stateMtx
+    bool stopping = false;            // stateMtx
+    std::unordered_map<std::string, Row> snapshot; // Worker thread only (after construction)
+    std::atomic<uint64_t> refreshCount{0};
+    std::atomic<uint64_t> deliveryCount{0};
+    std::thread worker;
+
+    void detach() {
+        ContextLock lock(ctx->mtx, "LiveQuery::detach");
+        if (listenerId) ctx->removeHookListener(listenerId);
+        listenerId = 0;
+    }
+
+    std::string rowKey(const Row& row) const {
+        std::string k;
+        for (const auto& col : key) {
+            auto it = row.find(col);
+            if (it == row.end()) throw std::runtime_error("Live query result has no key column: " + col);
+            appendValueKey(k, it->second);
+        }
+        return k;
+    }
+
+    void loop() {
+        LockPriorityScope background(LockPriority::BATCH); // Re-runs yield to callers' queries
+        std::unique_lock<std::mutex> lock(stateMtx);
+        while (true) {
+            cv.wait(lock, [&] { return dirty || stopping; });
+            if (stopping) return;
+            // Debounce: later commits during the wait are folded into this refresh
+            if (cv.wait_for(lock, debounce, [&] { return stopping; })) return;
+            dirty = false;
+            lock.unlock();
+
+            try {
+                refresh();
+            } catch (...) {
+                // A failed re-run (e.g. schema change) keeps the old snapshot; the next commit retries
+            }
+            lock.lock();
+        }
+    }
+
+    void refresh() {
+        refreshCount++;
+        std::unordered_map<std::string, Row> next;
+        for (auto& row : run()) {
+            std::string k = rowKey(row);
+            next.emplace(std::move(k), std::move(row));
+        }
+
+        WatchDelta delta;
+        for (const auto& [k, row] : next) {
+            auto it = snapshot.find(k);
+            if (it == snapshot.end()) delta.added.push_back(row);
+            else if (!(it->second == row)) delta.changed.push_back(row);
+        }
+        for (const auto& [k, row] : snapshot) {
+            if (!next.count(k)) delta.removed.push_back(row);
+        }
+        snapshot = std::move(next);
+
+        if (delta.added.empty() && delta.removed.empty() && delta.changed.empty()) return;
+        deliveryCount++;
+        cb(delta);
+    }
+};
+
 // ==========================================
 // 2. The Table Class
 // ==========================================
@@ -385,45 +3212,206 @@ private:
     std::string tableName;
     std::vector<ColumnDef> columns;
     std::shared_ptr<DBContext> ctx; // Shared ownership logic
+    bool indexFKs = false; // create() adds an index on every foreign key column
+    bool noRowid = false;  // create() emits WITHOUT ROWID
+    bool strictTypes = false; // create() emits STRICT
+
+    // Optional read-through cache for getById, invalidated through DBContext hooks
+    std::shared_ptr<RowCache> rowCache;
+    size_t rowCacheListener = 0;
+    std::string rowCacheKey; // INTEGER PRIMARY KEY column (the rowid alias)
+
+    // Helper to bind a variant value to a prepared statement
+    void bindValue(sqlite3_stmt* stmt, int index, const SQLValue& val) {
+        std::visit([&](auto&& arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, std::nullptr_t>) {
+                sqlite3_bind_null(stmt, index);
+            } else if constexpr (std::is_same_v<T, int>) {
+                sqlite3_bind_int(stmt, index, arg);
+            } else if constexpr (std::is_same_v<T, long long>) {
+                sqlite3_bind_int64(stmt, index, arg);
+            } else if constexpr (std::is_same_v<T, double>) {
+                sqlite3_bind_double(stmt, index, arg);
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                sqlite3_bind_text(stmt, index, arg.c_str(), -1, SQLITE_TRANSIENT);
+            } else if constexpr (std::is_same_v<T, std::vector<char>>) {
+                sqlite3_bind_blob(stmt, index, arg.data(), static_cast<int>(arg.size()), SQLITE_TRANSIENT);
+            }
+        }, val);
+    }
+
+    // Helper to extract a value from a statement column
+    SQLValue getColumnValue(sqlite3_stmt* stmt, int colIndex) {
+        int type = sqlite3_column_type(stmt, colIndex);
+        switch (type) {
+            case SQLITE_INTEGER:
+                return (long long)sqlite3_column_int64(stmt, colIndex);
+            case SQLITE_FLOAT:
+                return sqlite3_column_double(stmt, colIndex);
+            case SQLITE_TEXT:
+                return std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, colIndex)));
+            case SQLITE_BLOB: {
+                const char* blob = reinterpret_cast<const char*>(sqlite3_column_blob(stmt, colIndex));
+                int size = sqlite3_column_bytes(stmt, colIndex);
+                return std::vector<char>(blob, blob + size);
+            }
+            case SQLITE_NULL:
+            default:
+                return nullptr;
+        }
+    }
+
+    // SELECT statement text for select() and the streaming/columnar readers
+    std::string buildSelectSql(const std::vector<Condition>& where, const QueryOptions& opts) const {
+        std::stringstream ss;
+        
+        ss << "SELECT ";
+        if (opts.columns.empty()) {
+            ss << "*";
+        } else {
+            for (size_t i = 0; i < opts.columns.size(); ++i) {
+                // If column alias or complex expression, user must handle manually or we expand parser.
+                // For now, assuming direct column names or "table.col".
+                // Simple heuristic: if it contains space or function parens, don't quote.
+                // Otherwise split by '.' and quote parts.
+                std::string col = opts.columns[i];
+                if (col.find_first_of(" (") == std::string::npos) {
+                     size_t dot = col.find('.');
+                     if (dot != std::string::npos) {
+                         ss << quoteIdentifier(col.substr(0, dot)) << "." << quoteIdentifier(col.substr(dot+1));
+                     } else {
+                         ss << quoteIdentifier(col);
+                     }
+                } else {
+                    ss << col; // Leave as is if complex
+                }
+
+                if (i < opts.columns.size() - 1) ss << ", ";
+            }
+        }
+        
+        ss << " FROM " << quoteIdentifier(tableName);
+        
+        // Append Joins
+        for (const auto& join : opts.joins) {
+            ss << " " << join.getTypeString() << " " << quoteIdentifier(join.table) 
+               << " ON " << join.onCondition; // onCondition is raw SQL for now
+        }
+        
+        if (!where.empty()) {
+            ss << " WHERE ";
+            for (size_t i = 0; i < where.size(); ++i) {
+                ss << quoteIdentifier(where[i].column) << " " << where[i].getOpString() << " ?";
+                if (i < where.size() - 1) ss << " AND ";
+            }
+        }
+
+        if (!opts.groupBy.empty()) {
+            ss << " GROUP BY ";
+            for (size_t i = 0; i < opts.groupBy.size(); ++i) {
+                ss << quoteIdentifier(opts.groupBy[i]);
+                if (i < opts.groupBy.size() - 1) ss << ", ";
+            }
+        }
+
+        if (!opts.having.empty()) {
+            ss << " HAVING ";
+            for (size_t i = 0; i < opts.having.size(); ++i) {
+                // Heuristic: if contains space or paren, likely a function (COUNT(x)), don't quote
+                std::string col = opts.having[i].column;
+                if (col.find_first_of(" (") == std::string::npos) {
+                    ss << quoteIdentifier(col);
+                } else {
+                    ss << col;
+                }
+                
+                ss << " " << opts.having[i].getOpString() << " ?";
+                if (i < opts.having.size() - 1) ss << " AND ";
+            }
+        }
+
+        if (!opts.orderBy.empty()) {
+             // Heuristic quote for orderBy like columns
+             std::string order = opts.orderBy;
+             if (order.find_first_of(" (") == std::string::npos) {
+                 size_t dot = order.find('.');
+                 if (dot != std::string::npos) {
+                     ss << " ORDER BY " << quoteIdentifier(order.substr(0, dot)) << "." << quoteIdentifier(order.substr(dot+1));
+                 } else {
+                     ss << " ORDER BY " << quoteIdentifier(order);
+                 }
+             } else {
+                 ss << " ORDER BY " << order;
+             }
+             ss << (opts.orderDesc ? " DESC" : " ASC");
+        }
+        if (opts.limit >= 0) {
+            ss << " LIMIT " << opts.limit;
+        }
+        if (opts.offset >= 0) {
+            ss << " OFFSET " << opts.offset;
+        }
+        ss << ";";
+
+        return ss.str();
+    }
+
+    Row readRow(sqlite3_stmt* stmt) {
+        Row row;
+        int colCount = sqlite3_column_count(stmt);
+        for (int i = 0; i < colCount; ++i) {
+            std::string name = sqlite3_column_name(stmt, i);
+            row[name] = getColumnValue(stmt, i);
+        }
+        return row;
+    }
+
+    // Reads a statement column as T without going through SQLValue
+    template<typename T>
+    static T readColumn(sqlite3_stmt* stmt, int i) {
+        if constexpr (std::is_floating_point_v<T>) {
+            return static_cast<T>(sqlite3_column_double(stmt, i));
+        } else if constexpr (std::is_integral_v<T>) {
+            return static_cast<T>(sqlite3_column_int64(stmt, i));
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            const unsigned char* text = sqlite3_column_text(stmt, i);
+            return text ? std::string(reinterpret_cast<const char*>(text), sqlite3_column_bytes(stmt, i)) : std::string();
+        } else {
+            static_assert(std::is_arithmetic_v<T>, "Unsupported scalar type");
+        }
+    }
 
-    // Helper to bind a variant value to a prepared statement
-    void bindValue(sqlite3_stmt* stmt, int index, const SQLValue& val) {
-        std::visit([&](auto&& arg) {
-            using T = std::decay_t<decltype(arg)>;
-            if constexpr (std::is_same_v<T, std::nullptr_t>) {
-                sqlite3_bind_null(stmt, index);
-            } else if constexpr (std::is_same_v<T, int>) {
-                sqlite3_bind_int(stmt, index, arg);
-            } else if constexpr (std::is_same_v<T, long long>) {
-                sqlite3_bind_int64(stmt, index, arg);
-            } else if constexpr (std::is_same_v<T, double>) {
-                sqlite3_bind_double(stmt, index, arg);
-            } else if constexpr (std::is_same_v<T, std::string>) {
-                sqlite3_bind_text(stmt, index, arg.c_str(), -1, SQLITE_TRANSIENT);
-            } else if constexpr (std::is_same_v<T, std::vector<char>>) {
-                sqlite3_bind_blob(stmt, index, arg.data(), static_cast<int>(arg.size()), SQLITE_TRANSIENT);
-            }
-        }, val);
+    // Runs "SELECT <expr> FROM table WHERE ..." and reads the single result; nullopt
+    // when the result is NULL (SUM/MIN/MAX/AVG over no rows)
+    template<typename T>
+    std::optional<T> scalarQuery(const std::string& expr, const std::vector<Condition>& where, int limit = -1) {
+        QueryOptions opts;
+        opts.columns = {expr};
+        opts.limit = limit;
+
+        ContextLock lock(ctx->mtx, "Table::scalarQuery");
+        QueryBudget budget(*ctx, opts);
+        ScopedStmt stmt(ctx, buildSelectSql(where, opts));
+        bindSelect(stmt, where, opts);
+        int rc = sqlite3_step(stmt);
+        if (rc == SQLITE_DONE) return std::nullopt;
+        if (rc != SQLITE_ROW) {
+            budget.check(rc);
+            throw std::runtime_error("Aggregate failed: " + std::string(sqlite3_errmsg(ctx->db)));
+        }
+        if (sqlite3_column_type(stmt, 0) == SQLITE_NULL) return std::nullopt;
+        return readColumn<T>(stmt, 0);
     }
 
-    // Helper to extract a value from a statement column
-    SQLValue getColumnValue(sqlite3_stmt* stmt, int colIndex) {
-        int type = sqlite3_column_type(stmt, colIndex);
-        switch (type) {
-            case SQLITE_INTEGER:
-                return (long long)sqlite3_column_int64(stmt, colIndex);
-            case SQLITE_FLOAT:
-                return sqlite3_column_double(stmt, colIndex);
-            case SQLITE_TEXT:
-                return std::string(reinterpret_cast<const char*>(sqlite3_column_text(stmt, colIndex)));
-            case SQLITE_BLOB: {
-                const char* blob = reinterpret_cast<const char*>(sqlite3_column_blob(stmt, colIndex));
-                int size = sqlite3_column_bytes(stmt, colIndex);
-                return std::vector<char>(blob, blob + size);
-            }
-            case SQLITE_NULL:
-            default:
-                return nullptr;
+    // Binds WHERE then HAVING values in the order buildSelectSql emits placeholders
+    void bindSelect(sqlite3_stmt* stmt, const std::vector<Condition>& where, const QueryOptions& opts) {
+        int bindIdx = 1;
+        for (const auto& cond : where) {
+            bindValue(stmt, bindIdx++, cond.value);
+        }
+        for (const auto& cond : opts.having) {
+            bindValue(stmt, bindIdx++, cond.value);
         }
     }
 
@@ -431,11 +3419,19 @@ public:
     Table(std::string name, std::shared_ptr<DBContext> context) 
         : tableName(std::move(name)), ctx(std::move(context)) {}
 
+    // Same schema definition bound to another connection (snapshots); caches are not copied
+    Table(const Table& other, std::shared_ptr<DBContext> context)
+        : tableName(other.tableName), columns(other.columns), ctx(std::move(context)),
+          indexFKs(other.indexFKs), noRowid(other.noRowid), strictTypes(other.strictTypes) {}
+
+    const std::string& getName() const { return tableName; }
+    const std::vector<ColumnDef>& getColumns() const { return columns; }
+
     // --------------------------------------------------------
     // Schema Definition Methods
     // --------------------------------------------------------
     Table& addColumn(const std::string& name, SQLType type, bool primaryKey = false, bool autoInc = false) {
-        std::lock_guard<std::mutex> lock(ctx->mtx);
+        ContextLock lock(ctx->mtx, "Table::addColumn");
         ColumnDef col;
         col.name = name;
         col.type = type;
@@ -446,7 +3442,7 @@ public:
     }
 
     Table& addForeignKey(const std::string& name, SQLType type, const std::string& refTable, const std::string& refCol, bool onDeleteCascade = false) {
-        std::lock_guard<std::mutex> lock(ctx->mtx);
+        ContextLock lock(ctx->mtx, "Table::addForeignKey");
         ColumnDef col;
         col.name = name;
         col.type = type;
@@ -457,9 +3453,33 @@ public:
         return *this;
     }
 
+    // Have create() also index each foreign key child column (idx_<table>_<column>).
+    // Without it, every parent delete with ON DELETE CASCADE scans this table.
+    Table& indexForeignKeys(bool enable = true) {
+        ContextLock lock(ctx->mtx, "Table::indexForeignKeys");
+        indexFKs = enable;
+        return *this;
+    }
+
+    // Store the table as a single b-tree clustered on its PRIMARY KEY instead of a rowid
+    // b-tree plus a separate PK index. Requires a primary key; AUTOINCREMENT is not
+    // allowed, and insert() no longer returns a meaningful rowid.
+    Table& withoutRowid(bool enable = true) {
+        ContextLock lock(ctx->mtx, "Table::withoutRowid");
+        noRowid = enable;
+        return *this;
+    }
+
+    // Enforce declared column types on insert/update (SQLite 3.37+)
+    Table& strict(bool enable = true) {
+        ContextLock lock(ctx->mtx, "Table::strict");
+        strictTypes = enable;
+        return *this;
+    }
+
     // Create an Index
     void createIndex(const std::string& indexName, const std::string& column, bool unique = false) {
-        std::lock_guard<std::mutex> lock(ctx->mtx);
+        ContextLock lock(ctx->mtx, "Table::createIndex");
         std::stringstream ss;
         ss << "CREATE ";
         if (unique) ss << "UNIQUE ";
@@ -476,13 +3496,22 @@ public:
 
     // Must be called to actually create the table in SQLite
     void create() {
-        std::lock_guard<std::mutex> lock(ctx->mtx);
+        ContextLock lock(ctx->mtx, "Table::create");
         std::stringstream ss;
         ss << "CREATE TABLE IF NOT EXISTS " << quoteIdentifier(tableName) << " (";
         
         std::vector<std::string> pkCols;
         for (const auto& col : columns) {
             if (col.isPrimaryKey) pkCols.push_back(col.name);
+            if (noRowid && col.isAutoIncrement) {
+                throw std::runtime_error("Failed to create table " + tableName + ": AUTOINCREMENT is not allowed on WITHOUT ROWID tables");
+            }
+            if (strictTypes && col.type == SQLType::NULL_VAL) {
+                throw std::runtime_error("Failed to create table " + tableName + ": STRICT tables need a concrete type for column " + col.name);
+            }
+        }
+        if (noRowid && pkCols.empty()) {
+            throw std::runtime_error("Failed to create table " + tableName + ": WITHOUT ROWID tables need a PRIMARY KEY");
         }
 
         for (size_t i = 0; i < columns.size(); ++i) {
@@ -516,7 +3545,19 @@ public:
             ss << ")";
         }
 
-        ss << ");";
+        ss << ")";
+        if (strictTypes) ss << " STRICT";
+        if (strictTypes && noRowid) ss << ",";
+        if (noRowid) ss << " WITHOUT ROWID";
+        ss << ";";
+
+        if (indexFKs) {
+            for (const auto& col : columns) {
+                if (!col.foreignTable.has_value()) continue;
+                ss << " CREATE INDEX IF NOT EXISTS " << quoteIdentifier("idx_" + tableName + "_" + col.name)
+                   << " ON " << quoteIdentifier(tableName) << "(" << quoteIdentifier(col.name) << ");";
+            }
+        }
 
         std::string sql = ss.str();
         char* errMsg = nullptr;
@@ -528,6 +3569,12 @@ public:
         }
     }
 
+    // Foreign keys of this table with no supporting index on the child columns
+    std::vector<UnindexedForeignKey> unindexedForeignKeys() {
+        ContextLock lock(ctx->mtx, "Table::unindexedForeignKeys");
+        return findUnindexedForeignKeys(ctx->db, tableName);
+    }
+
     // --------------------------------------------------------
     // CRUD Operations
     // --------------------------------------------------------
@@ -535,7 +3582,9 @@ public:
     // CREATE (Insert)
     // Returns the last inserted row ID
     long long insert(const Row& row) {
-        std::lock_guard<std::mutex> lock(ctx->mtx);
+        OpTimer timer(ctx->activeMetrics(), MetricOp::INSERT);
+        ContextLock lock(ctx->mtx, "Table::insert");
+        timer.split(MetricPhase::LOCK_WAIT);
         std::stringstream ss;
         ss << "INSERT INTO " << quoteIdentifier(tableName) << " (";
         
@@ -554,142 +3603,543 @@ public:
             if (i < values.size() - 1) ss << ", ";
         }
         ss << ");";
+        std::string sql = ss.str();
+        timer.split(MetricPhase::BUILD);
 
-        ScopedStmt stmt(ctx, ss.str());
+        ScopedStmt stmt(ctx, sql);
+        timer.split(MetricPhase::PREPARE);
 
         for (int i = 0; i < values.size(); ++i) {
             bindValue(stmt, i + 1, values[i]);
         }
 
-        if (sqlite3_step(stmt) != SQLITE_DONE) {
+        int rc = sqlite3_step(stmt);
+        timer.split(MetricPhase::STEP);
+        if (rc != SQLITE_DONE) {
             throw std::runtime_error("Insert failed: " + std::string(sqlite3_errmsg(ctx->db)));
         }
 
         return sqlite3_last_insert_rowid(ctx->db);
     }
 
+    // Inserts values.size() / cols.size() rows given row-major in 'values', using
+    // multi-row INSERT statements of up to rowsPerStatement rows each. At most two
+    // statement shapes are prepared (full and tail), both kept in the statement cache.
+    void insertMany(const std::vector<std::string>& cols, const std::vector<SQLValue>& values, size_t rowsPerStatement = 256) {
+        if (cols.empty() || values.empty()) return;
+        if (values.size() % cols.size() != 0) {
+            throw std::runtime_error("Insert failed: value count is not a multiple of the column count");
+        }
+        ContextLock lock(ctx->mtx, "Table::insertMany");
+
+        size_t maxVars = static_cast<size_t>(sqlite3_limit(ctx->db, SQLITE_LIMIT_VARIABLE_NUMBER, -1));
+        rowsPerStatement = std::max<size_t>(1, std::min(rowsPerStatement, maxVars / cols.size()));
+
+        std::stringstream head;
+        head << "INSERT INTO " << quoteIdentifier(tableName) << " (";
+        for (size_t i = 0; i < cols.size(); ++i) {
+            head << quoteIdentifier(cols[i]);
+            if (i < cols.size() - 1) head << ", ";
+        }
+        head << ") VALUES ";
+
+        std::string placeholders = "(";
+        for (size_t i = 0; i < cols.size(); ++i) {
+            placeholders += (i < cols.size() - 1) ? "?, " : "?)";
+        }
+
+        size_t totalRows = values.size() / cols.size();
+        for (size_t row = 0; row < totalRows; row += rowsPerStatement) {
+            size_t n = std::min(rowsPerStatement, totalRows - row);
+            std::string sql = head.str();
+            for (size_t i = 0; i < n; ++i) {
+                sql += placeholders;
+                sql += (i < n - 1) ? ", " : ";";
+            }
+
+            ScopedStmt stmt(ctx, sql);
+            size_t base = row * cols.size();
+            for (size_t i = 0; i < n * cols.size(); ++i) {
+                bindValue(stmt, static_cast<int>(i + 1), values[base + i]);
+            }
+            if (sqlite3_step(stmt) != SQLITE_DONE) {
+                throw std::runtime_error("Insert failed: " + std::string(sqlite3_errmsg(ctx->db)));
+            }
+        }
+    }
+
     // READ (Select)
     std::vector<Row> select(const std::vector<Condition>& where = {}, const QueryOptions& opts = {}) {
-        std::lock_guard<std::mutex> lock(ctx->mtx);
-        std::stringstream ss;
-        
-        ss << "SELECT ";
-        if (opts.columns.empty()) {
-            ss << "*";
-        } else {
-            for (size_t i = 0; i < opts.columns.size(); ++i) {
-                // If column alias or complex expression, user must handle manually or we expand parser.
-                // For now, assuming direct column names or "table.col".
-                // Simple heuristic: if it contains space or function parens, don't quote.
-                // Otherwise split by '.' and quote parts.
-                std::string col = opts.columns[i];
-                if (col.find_first_of(" (") == std::string::npos) {
-                     size_t dot = col.find('.');
-                     if (dot != std::string::npos) {
-                         ss << quoteIdentifier(col.substr(0, dot)) << "." << quoteIdentifier(col.substr(dot+1));
-                     } else {
-                         ss << quoteIdentifier(col);
-                     }
-                } else {
-                    ss << col; // Leave as is if complex
-                }
+        OpTimer timer(ctx->activeMetrics(), MetricOp::SELECT);
+        ContextLock lock(ctx->mtx, "Table::select");
+        timer.split(MetricPhase::LOCK_WAIT);
+        std::string sql = buildSelectSql(where, opts);
+        timer.split(MetricPhase::BUILD);
 
-                if (i < opts.columns.size() - 1) ss << ", ";
+        std::string cacheKey;
+        ResultCache* cache = opts.cache ? ctx->resultCache.get() : nullptr;
+        if (cache) {
+            cacheKey = ResultCache::makeKey(sql, where, opts.having);
+            if (const auto* hit = cache->get(cacheKey)) return *hit;
+        }
+
+        QueryBudget budget(*ctx, opts);
+        ScopedStmt stmt(ctx, sql);
+        timer.split(MetricPhase::PREPARE);
+        bindSelect(stmt, where, opts);
+
+        std::vector<Row> results;
+        int rc;
+        for (;;) {
+            rc = sqlite3_step(stmt);
+            timer.split(MetricPhase::STEP);
+            if (rc != SQLITE_ROW) break;
+            results.push_back(readRow(stmt));
+            timer.split(MetricPhase::MATERIALIZE);
+        }
+        if (rc != SQLITE_DONE) {
+            budget.check(rc);
+            throw std::runtime_error("Select failed: " + std::string(sqlite3_errmsg(ctx->db)));
+        }
+
+        if (cache) {
+            // Only results whose every table reports its writes through the update hook
+            // can be invalidated; anything else is returned uncached
+            std::vector<std::string> tables = {asciiLower(tableName)};
+            for (const auto& join : opts.joins) tables.push_back(asciiLower(join.table));
+            bool trackable = true;
+            for (const auto& t : tables) trackable = trackable && isRowidTable(ctx->db, t);
+            if (trackable) {
+                for (const auto& t : tables) ctx->trackDeletes(t);
+                cache->put(cacheKey, results, tables, opts.cacheTtl);
             }
         }
-        
-        ss << " FROM " << quoteIdentifier(tableName);
-        
-        // Append Joins
-        for (const auto& join : opts.joins) {
-            ss << " " << join.getTypeString() << " " << quoteIdentifier(join.table) 
-               << " ON " << join.onCondition; // onCondition is raw SQL for now
+
+        return results;
+    }
+
+    // Live query: runs select(where, opts) now and passes the whole result to 'callback' as
+    // 'added' before returning, then re-runs it in the background after commits on this
+    // connection that write the table or a joined table, delivering only the rows added,
+    // removed or changed (matched by watchOpts.key, default the primary key). Queries whose
+    // rows have no such key (GROUP BY, joins returning duplicate names) must set the key.
+    // Every table read must be an ordinary rowid table: writes to WITHOUT ROWID tables and
+    // views never reach the update hook, so such a query would never refresh and throws.
+    // Stop or destroy the handle before the Database.
+    std::unique_ptr<LiveQuery> watch(const std::vector<Condition>& where, const QueryOptions& opts,
+                                     LiveQuery::Callback callback, const WatchOptions& watchOpts = {}) {
+        std::vector<std::string> key = watchOpts.key;
+        if (key.empty()) {
+            for (const auto& col : columns) {
+                if (col.isPrimaryKey) key.push_back(col.name);
+            }
         }
-        
-        if (!where.empty()) {
-            ss << " WHERE ";
-            for (size_t i = 0; i < where.size(); ++i) {
-                ss << quoteIdentifier(where[i].column) << " " << where[i].getOpString() << " ?";
-                if (i < where.size() - 1) ss << " AND ";
+        if (key.empty()) {
+            throw std::runtime_error("watch() needs WatchOptions::key for table without a primary key: " + tableName);
+        }
+
+        std::vector<std::string> tables = {asciiLower(tableName)};
+        for (const auto& join : opts.joins) tables.push_back(asciiLower(join.table));
+        {
+            ContextLock lock(ctx->mtx, "Table::watch");
+            for (const auto& t : tables) {
+                if (!isRowidTable(ctx->db, t)) {
+                    throw std::runtime_error("watch() on " + tableName + " needs rowid tables, but " + t
+                                             + " is WITHOUT ROWID, a view or missing");
+                }
             }
         }
 
-        if (!opts.groupBy.empty()) {
-            ss << " GROUP BY ";
-            for (size_t i = 0; i < opts.groupBy.size(); ++i) {
-                ss << quoteIdentifier(opts.groupBy[i]);
-                if (i < opts.groupBy.size() - 1) ss << ", ";
+        QueryOptions liveOpts = opts;
+        liveOpts.cache = false; // Every refresh must see the committed data
+        return std::make_unique<LiveQuery>(ctx, std::move(tables), std::move(key),
+                                           [this, where, liveOpts] { return select(where, liveOpts); },
+                                           std::move(callback), watchOpts.debounce);
+    }
+
+    // Streams the query result to 'out' as CSV or NDJSON, formatting straight from the
+    // statement columns into an ExportBuffer; no Row is materialized. NULL is an empty
+    // CSV field / JSON null, BLOBs are written as lowercase hex. Returns the row count.
+    size_t exportTo(std::ostream& out, ExportFormat format, const std::vector<Condition>& where = {},
+                    const QueryOptions& opts = {}, const ExportOptions& exportOpts = {}) {
+        ContextLock lock(ctx->mtx, "Table::exportTo");
+        QueryBudget budget(*ctx, opts);
+        ScopedStmt stmt(ctx, buildSelectSql(where, opts));
+        bindSelect(stmt, where, opts);
+
+        ExportBuffer buf(out, exportOpts.bufferBytes);
+        int colCount = sqlite3_column_count(stmt);
+        const char delim = exportOpts.delimiter;
+
+        // Column names are escaped once up front: CSV header fields, or '{"name":' JSON keys
+        std::vector<std::string> keys(colCount);
+        for (int i = 0; i < colCount; ++i) {
+            const char* name = sqlite3_column_name(stmt, i);
+            if (format == ExportFormat::CSV) {
+                csvAppendField(keys[i], name, std::strlen(name), delim);
+            } else {
+                keys[i] = (i == 0) ? "{" : ",";
+                jsonAppendString(keys[i], name, std::strlen(name));
+                keys[i] += ':';
+            }
+        }
+        if (format == ExportFormat::CSV && exportOpts.header) {
+            for (int i = 0; i < colCount; ++i) {
+                if (i > 0) buf.put(delim);
+                buf.append(keys[i]);
             }
+            buf.put('\n');
         }
 
-        if (!opts.having.empty()) {
-            ss << " HAVING ";
-            for (size_t i = 0; i < opts.having.size(); ++i) {
-                // Heuristic: if contains space or paren, likely a function (COUNT(x)), don't quote
-                std::string col = opts.having[i].column;
-                if (col.find_first_of(" (") == std::string::npos) {
-                    ss << quoteIdentifier(col);
+        size_t rows = 0;
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            for (int i = 0; i < colCount; ++i) {
+                if (format == ExportFormat::CSV) {
+                    if (i > 0) buf.put(delim);
                 } else {
-                    ss << col;
+                    buf.append(keys[i]);
+                }
+
+                switch (sqlite3_column_type(stmt, i)) {
+                    case SQLITE_INTEGER:
+                        buf.appendInt(sqlite3_column_int64(stmt, i));
+                        break;
+                    case SQLITE_FLOAT: {
+                        double v = sqlite3_column_double(stmt, i);
+                        if (format == ExportFormat::NDJSON && !std::isfinite(v)) buf.append("null", 4);
+                        else buf.appendDouble(v);
+                        break;
+                    }
+                    case SQLITE_TEXT: {
+                        const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
+                        size_t n = static_cast<size_t>(sqlite3_column_bytes(stmt, i));
+                        if (format == ExportFormat::CSV) buf.appendCsvField(text, n, delim);
+                        else buf.appendJsonString(text, n);
+                        break;
+                    }
+                    case SQLITE_BLOB: {
+                        const unsigned char* blob = static_cast<const unsigned char*>(sqlite3_column_blob(stmt, i));
+                        size_t n = static_cast<size_t>(sqlite3_column_bytes(stmt, i));
+                        // Quoted in CSV too when empty, so it doesn't read back as NULL
+                        bool quote = format == ExportFormat::NDJSON || n == 0;
+                        if (quote) buf.put('"');
+                        buf.appendHex(blob, n);
+                        if (quote) buf.put('"');
+                        break;
+                    }
+                    default:
+                        if (format == ExportFormat::NDJSON) buf.append("null", 4);
+                        break;
                 }
-                
-                ss << " " << opts.having[i].getOpString() << " ?";
-                if (i < opts.having.size() - 1) ss << " AND ";
             }
+            if (format == ExportFormat::NDJSON) buf.append(colCount ? "}\n" : "{}\n", colCount ? 2 : 3);
+            else buf.put('\n');
+            buf.endRecord();
+            ++rows;
         }
+        if (rc != SQLITE_DONE) {
+            budget.check(rc);
+            throw std::runtime_error("Export failed: " + std::string(sqlite3_errmsg(ctx->db)));
+        }
+        buf.flush();
+        return rows;
+    }
 
-        if (!opts.orderBy.empty()) {
-             // Heuristic quote for orderBy like columns
-             std::string order = opts.orderBy;
-             if (order.find_first_of(" (") == std::string::npos) {
-                 size_t dot = order.find('.');
-                 if (dot != std::string::npos) {
-                     ss << " ORDER BY " << quoteIdentifier(order.substr(0, dot)) << "." << quoteIdentifier(order.substr(dot+1));
-                 } else {
-                     ss << " ORDER BY " << quoteIdentifier(order);
-                 }
-             } else {
-                 ss << " ORDER BY " << order;
-             }
-             ss << (opts.orderDesc ? " DESC" : " ASC");
+    // Fills contiguous, Arrow-layout column buffers straight from the statement. Each
+    // column's type comes from its declared type, or from its first non-NULL value for
+    // expressions. Values of another storage class are converted by SQLite, except that
+    // a REAL arriving in an INTEGER column widens the whole column to REAL.
+    ColumnarResult selectColumnar(const std::vector<Condition>& where = {}, const QueryOptions& opts = {}) {
+        ContextLock lock(ctx->mtx, "Table::selectColumnar");
+        QueryBudget budget(*ctx, opts);
+        ScopedStmt stmt(ctx, buildSelectSql(where, opts));
+        bindSelect(stmt, where, opts);
+
+        ColumnarResult result;
+        int colCount = sqlite3_column_count(stmt);
+        result.columns.resize(colCount);
+        for (int i = 0; i < colCount; ++i) {
+            auto& col = result.columns[i];
+            col.name = sqlite3_column_name(stmt, i);
+            const char* decl = sqlite3_column_decltype(stmt, i);
+            if (!decl) continue;
+            std::string d = decl;
+            std::transform(d.begin(), d.end(), d.begin(), ::toupper);
+            // SQLite column affinity rules; NUMERIC affinity is decided by the data
+            if (d.find("INT") != std::string::npos) col.type = SQLType::INTEGER;
+            else if (d.find("CHAR") != std::string::npos || d.find("CLOB") != std::string::npos || d.find("TEXT") != std::string::npos) col.type = SQLType::TEXT;
+            else if (d.find("BLOB") != std::string::npos) col.type = SQLType::BLOB;
+            else if (d.find("REAL") != std::string::npos || d.find("FLOA") != std::string::npos || d.find("DOUB") != std::string::npos) col.type = SQLType::REAL;
+            if (col.type == SQLType::TEXT || col.type == SQLType::BLOB) col.offsets.push_back(0);
         }
-        if (opts.limit >= 0) {
-            ss << " LIMIT " << opts.limit;
+
+        size_t row = 0;
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            for (int i = 0; i < colCount; ++i) {
+                auto& col = result.columns[i];
+                int storage = sqlite3_column_type(stmt, i);
+                if (row % 8 == 0) col.validity.push_back(0);
+
+                // First non-NULL value fixes an undeclared column's type; earlier rows become NULL slots
+                if (col.type == SQLType::NULL_VAL && storage != SQLITE_NULL) {
+                    switch (storage) {
+                        case SQLITE_INTEGER: col.type = SQLType::INTEGER; col.ints.resize(row); break;
+                        case SQLITE_FLOAT:   col.type = SQLType::REAL; col.doubles.resize(row); break;
+                        case SQLITE_TEXT:    col.type = SQLType::TEXT; col.offsets.assign(row + 1, 0); break;
+                        default:             col.type = SQLType::BLOB; col.offsets.assign(row + 1, 0); break;
+                    }
+                }
+                if (col.type == SQLType::INTEGER && storage == SQLITE_FLOAT) {
+                    col.type = SQLType::REAL;
+                    col.doubles.assign(col.ints.begin(), col.ints.end());
+                    col.ints.clear();
+                    col.ints.shrink_to_fit();
+                }
+
+                if (storage == SQLITE_NULL) {
+                    ++col.nullCount;
+                } else {
+                    col.validity[row >> 3] |= static_cast<uint8_t>(1u << (row & 7));
+                }
+                switch (col.type) {
+                    case SQLType::INTEGER:
+                        col.ints.push_back(storage == SQLITE_NULL ? 0 : sqlite3_column_int64(stmt, i));
+                        break;
+                    case SQLType::REAL:
+                        col.doubles.push_back(storage == SQLITE_NULL ? 0.0 : sqlite3_column_double(stmt, i));
+                        break;
+                    case SQLType::TEXT:
+                    case SQLType::BLOB: {
+                        if (storage != SQLITE_NULL) {
+                            const char* data = col.type == SQLType::TEXT
+                                ? reinterpret_cast<const char*>(sqlite3_column_text(stmt, i))
+                                : static_cast<const char*>(sqlite3_column_blob(stmt, i));
+                            size_t n = static_cast<size_t>(sqlite3_column_bytes(stmt, i));
+                            if (col.bytes.size() + n > static_cast<size_t>(INT32_MAX)) {
+                                throw std::runtime_error("Columnar select failed: column " + col.name + " exceeds 2 GiB of data");
+                            }
+                            col.bytes.insert(col.bytes.end(), data, data + n);
+                        }
+                        col.offsets.push_back(static_cast<int32_t>(col.bytes.size()));
+                        break;
+                    }
+                    default:
+                        break; // Still all NULL
+                }
+            }
+            ++row;
         }
-        if (opts.offset >= 0) {
-            ss << " OFFSET " << opts.offset;
+        if (rc != SQLITE_DONE) {
+            budget.check(rc);
+            throw std::runtime_error("Columnar select failed: " + std::string(sqlite3_errmsg(ctx->db)));
         }
-        ss << ";";
 
-        ScopedStmt stmt(ctx, ss.str());
+        result.rows = row;
+        return result;
+    }
 
-        int bindIdx = 1;
-        for (const auto& cond : where) {
-            bindValue(stmt, bindIdx++, cond.value);
+    // Reads one numeric column into a contiguous vector (T = double, int64_t, int, ...),
+    // converting each value with sqlite3_column_double / sqlite3_column_int64. NULLs are
+    // skipped, as SQL aggregates do; use selectColumnar when rows must stay aligned.
+    template<typename T>
+    std::vector<T> column(const std::string& name, const std::vector<Condition>& where = {}, const QueryOptions& opts = {}) {
+        static_assert(std::is_arithmetic_v<T>, "column<T> needs a numeric type");
+        QueryOptions colOpts = opts;
+        colOpts.columns = {name};
+
+        ContextLock lock(ctx->mtx, "Table::column");
+        QueryBudget budget(*ctx, colOpts);
+        ScopedStmt stmt(ctx, buildSelectSql(where, colOpts));
+        bindSelect(stmt, where, colOpts);
+
+        std::vector<T> values;
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            if (sqlite3_column_type(stmt, 0) == SQLITE_NULL) continue;
+            if constexpr (std::is_floating_point_v<T>) {
+                values.push_back(static_cast<T>(sqlite3_column_double(stmt, 0)));
+            } else {
+                values.push_back(static_cast<T>(sqlite3_column_int64(stmt, 0)));
+            }
         }
-        for (const auto& cond : opts.having) {
-            bindValue(stmt, bindIdx++, cond.value);
+        if (rc != SQLITE_DONE) {
+            budget.check(rc);
+            throw std::runtime_error("Column select failed: " + std::string(sqlite3_errmsg(ctx->db)));
         }
+        return values;
+    }
 
-        std::vector<Row> results;
-        while (sqlite3_step(stmt) == SQLITE_ROW) {
-            Row row;
-            int colCount = sqlite3_column_count(stmt);
-            for (int i = 0; i < colCount; ++i) {
-                std::string name = sqlite3_column_name(stmt, i);
-                row[name] = getColumnValue(stmt, i);
+    // --------------------------------------------------------
+    // Primary Key Lookups & Row Cache
+    // --------------------------------------------------------
+
+    // Serves getById/queryById from an in-process LRU of up to maxBytes, split into
+    // 'shards' independently locked parts. Entries are invalidated through the update
+    // hook on every insert/update/delete of this table on this connection, including
+    // raw SQL, cascades and DELETE without WHERE (see DBContext::authorizer), and the whole
+    // cache is dropped on ROLLBACK. Requires a single INTEGER PRIMARY KEY column (the rowid
+    // alias), since the hook reports rowids. Not seen by the hook: writes from other
+    // connections/processes, and rows removed by REPLACE conflict resolution.
+    Table& enableRowCache(size_t maxBytes = 64 << 20, size_t shards = 16) {
+        ContextLock lock(ctx->mtx, "Table::enableRowCache");
+        std::vector<const ColumnDef*> pk;
+        for (const auto& col : columns) {
+            if (col.isPrimaryKey) pk.push_back(&col);
+        }
+        if (pk.size() != 1 || pk[0]->type != SQLType::INTEGER || noRowid) {
+            throw std::runtime_error("Row cache on " + tableName + " needs a single INTEGER PRIMARY KEY column on a rowid table");
+        }
+        if (rowCacheListener) ctx->removeHookListener(rowCacheListener);
+
+        auto cache = std::make_shared<RowCache>(maxBytes, shards);
+        std::atomic_store(&rowCache, cache);
+        rowCacheKey = pk[0]->name;
+        std::weak_ptr<RowCache> weak = cache;
+        std::string name = tableName;
+        DBContext::HookListener listener;
+        listener.onUpdate = [weak, name](int, const char* table, sqlite3_int64 rowid) {
+            if (name != table) return;
+            if (auto cache = weak.lock()) cache->invalidate(rowid);
+        };
+        // Rows read inside a rolled-back transaction may have been cached
+        listener.onRollback = [weak]() {
+            if (auto cache = weak.lock()) cache->clear();
+        };
+        rowCacheListener = ctx->addHookListener(std::move(listener));
+        ctx->trackDeletes(asciiLower(tableName));
+        return *this;
+    }
+
+    void disableRowCache() {
+        ContextLock lock(ctx->mtx, "Table::disableRowCache");
+        if (rowCacheListener) ctx->removeHookListener(rowCacheListener);
+        rowCacheListener = 0;
+        std::atomic_store(&rowCache, std::shared_ptr<RowCache>());
+    }
+
+    RowCache::Stats rowCacheStats() const {
+        auto cache = std::atomic_load(&rowCache);
+        return cache ? cache->stats() : RowCache::Stats{};
+    }
+
+    // Row whose primary key is 'id'. Cache hits only take the cache shard's lock; on a
+    // miss the row is read and cached while holding the connection lock, so no write can
+    // slip in between the read and the cache fill.
+    std::optional<Row> getById(long long id) {
+        std::shared_ptr<RowCache> cache = std::atomic_load(&rowCache);
+        if (cache) {
+            if (auto hit = cache->get(id)) return hit;
+        }
+
+        ContextLock lock(ctx->mtx, "Table::getById");
+        std::string key = rowCacheKey;
+        if (key.empty()) {
+            for (const auto& col : columns) {
+                if (col.isPrimaryKey) key = col.name;
             }
-            results.push_back(row);
+            if (key.empty()) key = "rowid";
+        }
+        std::vector<Condition> where = { Condition{key, Op::EQ, id} };
+        ScopedStmt stmt(ctx, buildSelectSql(where, {}));
+        bindSelect(stmt, where, {});
+        int rc = sqlite3_step(stmt);
+        if (rc == SQLITE_DONE) return std::nullopt;
+        if (rc != SQLITE_ROW) {
+            throw std::runtime_error("Select failed: " + std::string(sqlite3_errmsg(ctx->db)));
+        }
+        Row row = readRow(stmt);
+        if (cache) cache->put(id, row);
+        return row;
+    }
+
+    template<typename T>
+    std::optional<T> queryById(long long id) {
+        auto row = getById(id);
+        if (!row) return std::nullopt;
+        return rowToStruct<T>(*row);
+    }
+
+    // --------------------------------------------------------
+    // Typed Aggregates
+    // --------------------------------------------------------
+    // Each runs one cached statement and reads scalars directly, without building Rows.
+
+    long long count(const std::vector<Condition>& where = {}) {
+        return scalarQuery<long long>("COUNT(*)", where).value_or(0);
+    }
+
+    // SELECT 1 ... LIMIT 1: stops at the first matching row
+    bool exists(const std::vector<Condition>& where = {}) {
+        return scalarQuery<long long>("1 AS found", where, 1).has_value();
+    }
+
+    // 0 when no row matches
+    template<typename T>
+    T sum(const std::string& column, const std::vector<Condition>& where = {}) {
+        return scalarQuery<T>("SUM(" + quoteIdentifier(column) + ")", where).value_or(T{});
+    }
+
+    std::optional<double> avg(const std::string& column, const std::vector<Condition>& where = {}) {
+        return scalarQuery<double>("AVG(" + quoteIdentifier(column) + ")", where);
+    }
+
+    template<typename T>
+    std::optional<T> min(const std::string& column, const std::vector<Condition>& where = {}) {
+        return scalarQuery<T>("MIN(" + quoteIdentifier(column) + ")", where);
+    }
+
+    template<typename T>
+    std::optional<T> max(const std::string& column, const std::vector<Condition>& where = {}) {
+        return scalarQuery<T>("MAX(" + quoteIdentifier(column) + ")", where);
+    }
+
+    // SELECT groupColumn, AGG(column) ... GROUP BY groupColumn, as (key, value) pairs in
+    // key order. 'column' is ignored for COUNT, which counts rows.
+    template<typename K, typename V>
+    std::vector<std::pair<K, V>> aggregateBy(const std::string& groupColumn, Aggregate agg, const std::string& column,
+                                             const std::vector<Condition>& where = {}) {
+        QueryOptions opts;
+        std::string expr = agg == Aggregate::COUNT ? std::string("COUNT(*)") : aggregateToString(agg) + "(" + quoteIdentifier(column) + ")";
+        opts.columns = {groupColumn, expr};
+        opts.groupBy = {groupColumn};
+        opts.orderBy = groupColumn;
+
+        ContextLock lock(ctx->mtx, "Table::aggregateBy");
+        QueryBudget budget(*ctx, opts);
+        ScopedStmt stmt(ctx, buildSelectSql(where, opts));
+        bindSelect(stmt, where, opts);
+
+        std::vector<std::pair<K, V>> groups;
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            groups.emplace_back(readColumn<K>(stmt, 0), readColumn<V>(stmt, 1));
+        }
+        if (rc != SQLITE_DONE) {
+            budget.check(rc);
+            throw std::runtime_error("Aggregate failed: " + std::string(sqlite3_errmsg(ctx->db)));
         }
+        return groups;
+    }
 
-        return results;
+    template<typename K>
+    std::vector<std::pair<K, long long>> countBy(const std::string& groupColumn, const std::vector<Condition>& where = {}) {
+        return aggregateBy<K, long long>(groupColumn, Aggregate::COUNT, "", where);
+    }
+
+    template<typename K, typename V>
+    std::vector<std::pair<K, V>> sumBy(const std::string& groupColumn, const std::string& column, const std::vector<Condition>& where = {}) {
+        return aggregateBy<K, V>(groupColumn, Aggregate::SUM, column, where);
     }
 
     // UPDATE
     void update(const Row& data, const std::vector<Condition>& where) {
         if (data.empty()) return;
 
-        std::lock_guard<std::mutex> lock(ctx->mtx);
+        OpTimer timer(ctx->activeMetrics(), MetricOp::UPDATE);
+        ContextLock lock(ctx->mtx, "Table::update");
+        timer.split(MetricPhase::LOCK_WAIT);
         std::stringstream ss;
         ss << "UPDATE " << quoteIdentifier(tableName) << " SET ";
         
@@ -711,20 +4161,28 @@ public:
             }
         }
 
-        ScopedStmt stmt(ctx, ss.str());
+        std::string sql = ss.str();
+        timer.split(MetricPhase::BUILD);
+
+        ScopedStmt stmt(ctx, sql);
+        timer.split(MetricPhase::PREPARE);
 
         for (int i = 0; i < bindings.size(); ++i) {
             bindValue(stmt, i + 1, bindings[i]);
         }
 
-        if (sqlite3_step(stmt) != SQLITE_DONE) {
+        int rc = sqlite3_step(stmt);
+        timer.split(MetricPhase::STEP);
+        if (rc != SQLITE_DONE) {
             throw std::runtime_error("Update failed: " + std::string(sqlite3_errmsg(ctx->db)));
         }
     }
 
     // DELETE
     void remove(const std::vector<Condition>& where) {
-        std::lock_guard<std::mutex> lock(ctx->mtx);
+        OpTimer timer(ctx->activeMetrics(), MetricOp::REMOVE);
+        ContextLock lock(ctx->mtx, "Table::remove");
+        timer.split(MetricPhase::LOCK_WAIT);
         std::stringstream ss;
         ss << "DELETE FROM " << quoteIdentifier(tableName);
 
@@ -736,13 +4194,19 @@ public:
             }
         }
 
-        ScopedStmt stmt(ctx, ss.str());
+        std::string sql = ss.str();
+        timer.split(MetricPhase::BUILD);
+
+        ScopedStmt stmt(ctx, sql);
+        timer.split(MetricPhase::PREPARE);
 
         for (int i = 0; i < where.size(); ++i) {
             bindValue(stmt, i + 1, where[i].value);
         }
 
-        if (sqlite3_step(stmt) != SQLITE_DONE) {
+        int rc = sqlite3_step(stmt);
+        timer.split(MetricPhase::STEP);
+        if (rc != SQLITE_DONE) {
             throw std::runtime_error("Delete failed: " + std::string(sqlite3_errmsg(ctx->db)));
         }
     }
@@ -784,17 +4248,188 @@ private:
     std::shared_ptr<DBContext> ctx;
     std::map<std::string, Table> tables;
 
+    struct MaterializedView {
+        std::string base;
+        std::vector<std::string> groupBy;
+        std::vector<ViewAggregate> aggregates;
+    };
+    std::map<std::string, MaterializedView> views;
+
+    // Runs 'statements' inside a savepoint, so they apply all-or-nothing with or without
+    // an enclosing transaction. Caller must hold mtx.
+    void runAtomically(const std::vector<std::string>& statements, const std::string& what) {
+        execOrThrow(ctx->db, "SAVEPOINT sqldb_atomic;", what + " failed");
+        try {
+            for (const auto& sql : statements) execOrThrow(ctx->db, sql, what + " failed");
+        } catch (...) {
+            sqlite3_exec(ctx->db, "ROLLBACK TO sqldb_atomic; RELEASE sqldb_atomic;", nullptr, nullptr, nullptr);
+            throw;
+        }
+        execOrThrow(ctx->db, "RELEASE sqldb_atomic;", what + " failed");
+    }
+
+    // "g1 IS <row>.g1 AND ..." matching a view row to the group of a base row
+    static std::string viewGroupMatch(const MaterializedView& v, const std::string& row, const std::string& qualifier = "") {
+        std::string match;
+        for (const auto& g : v.groupBy) {
+            if (!match.empty()) match += " AND ";
+            match += qualifier + quoteIdentifier(g) + " IS " + row + "." + quoteIdentifier(g);
+        }
+        return match.empty() ? "1" : match;
+    }
+
+    // Trigger body statements adding ('NEW') or removing ('OLD') one base row
+    static std::string viewApplyRow(const std::string& name, const MaterializedView& v, const std::string& row) {
+        const bool add = row == "NEW";
+        const std::string view = quoteIdentifier(name);
+        const std::string match = viewGroupMatch(v, row);
+        std::string sql;
+
+        if (add) {
+            // Create the group row on first sight; '_rows' and counters start at 0
+            std::string cols, vals;
+            for (const auto& g : v.groupBy) {
+                cols += quoteIdentifier(g) + ", ";
+                vals += row + "." + quoteIdentifier(g) + ", ";
+            }
+            cols += "\"_rows\"";
+            vals += "0";
+            for (const auto& a : v.aggregates) {
+                if (a.fn == Aggregate::COUNT) { cols += ", " + quoteIdentifier(a.as); vals += ", 0"; }
+                if (a.fn == Aggregate::SUM) { cols += ", " + quoteIdentifier("_n_" + a.as); vals += ", 0"; }
+            }
+            sql += "INSERT INTO " + view + " (" + cols + ") SELECT " + vals
+                 + " WHERE NOT EXISTS (SELECT 1 FROM " + view + " WHERE " + match + "); ";
+        }
+
+        const std::string sign = add ? " + " : " - ";
+        std::string sets = "\"_rows\" = \"_rows\"" + sign + "1";
+        for (const auto& a : v.aggregates) {
+            const std::string out = quoteIdentifier(a.as);
+            const std::string in = row + "." + quoteIdentifier(a.column);
+            const std::string notNull = "(" + in + " IS NOT NULL)";
+            sets += ", " + out + " = ";
+            switch (a.fn) {
+                case Aggregate::COUNT:
+                    sets += out + sign + (a.column.empty() ? "1" : notNull);
+                    break;
+                case Aggregate::SUM: {
+                    const std::string n = quoteIdentifier("_n_" + a.as);
+                    if (add) sets += "CASE WHEN " + in + " IS NULL THEN " + out + " ELSE COALESCE(" + out + ", 0) + " + in + " END";
+                    else sets += "CASE WHEN " + in + " IS NULL THEN " + out + " WHEN " + n + " = 1 THEN NULL ELSE " + out + " - " + in + " END";
+                    sets += ", " + n + " = " + n + sign + notNull;
+                    break;
+                }
+                case Aggregate::MIN:
+                case Aggregate::MAX: {
+                    const char* cmp = a.fn == Aggregate::MIN ? " < " : " > ";
+                    if (add) {
+                        sets += "CASE WHEN " + in + " IS NOT NULL AND (" + out + " IS NULL OR " + in + cmp + out + ") THEN " + in + " ELSE " + out + " END";
+                    } else {
+                        // Removing the current extreme: re-scan what is left of the group
+                        sets += "CASE WHEN " + in + " IS NOT NULL AND " + in + " = " + out + " THEN (SELECT "
+                              + aggregateToString(a.fn) + "(_b." + quoteIdentifier(a.column) + ") FROM " + quoteIdentifier(v.base)
+                              + " AS _b WHERE " + viewGroupMatch(v, row, "_b.") + ") ELSE " + out + " END";
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+        sql += "UPDATE " + view + " SET " + sets + " WHERE " + match + "; ";
+        if (!add) sql += "DELETE FROM " + view + " WHERE " + match + " AND \"_rows\" = 0; ";
+        return sql;
+    }
+
+    static std::vector<std::string> materializedViewTriggers(const std::string& name, const MaterializedView& v) {
+        const std::string base = quoteIdentifier(v.base);
+        auto trigger = [&](const char* suffix) { return quoteIdentifier("_sqldb_mv_" + name + suffix); };
+
+        std::vector<std::string> watched;
+        for (const auto& g : v.groupBy) watched.push_back(g);
+        for (const auto& a : v.aggregates) {
+            if (!a.column.empty() && std::find(watched.begin(), watched.end(), a.column) == watched.end()) watched.push_back(a.column);
+        }
+
+        std::vector<std::string> sql;
+        for (const char* suffix : {"_ins", "_upd", "_del"}) {
+            sql.push_back("DROP TRIGGER IF EXISTS " + trigger(suffix) + ";");
+        }
+        sql.push_back("CREATE TRIGGER " + trigger("_ins") + " AFTER INSERT ON " + base
+                      + " BEGIN " + viewApplyRow(name, v, "NEW") + "END;");
+        sql.push_back("CREATE TRIGGER " + trigger("_del") + " AFTER DELETE ON " + base
+                      + " BEGIN " + viewApplyRow(name, v, "OLD") + "END;");
+        if (!watched.empty()) {
+            std::string cols;
+            for (const auto& c : watched) cols += (cols.empty() ? "" : ", ") + quoteIdentifier(c);
+            // An update moves the row out of its old group and into its new one
+            sql.push_back("CREATE TRIGGER " + trigger("_upd") + " AFTER UPDATE OF " + cols + " ON " + base
+                          + " BEGIN " + viewApplyRow(name, v, "OLD") + viewApplyRow(name, v, "NEW") + "END;");
+        }
+        return sql;
+    }
+
+    static std::vector<std::string> materializedViewRebuild(const std::string& name, const MaterializedView& v) {
+        std::string cols, exprs, groups;
+        for (const auto& g : v.groupBy) {
+            cols += quoteIdentifier(g) + ", ";
+            exprs += quoteIdentifier(g) + ", ";
+            groups += (groups.empty() ? "" : ", ") + quoteIdentifier(g);
+        }
+        cols += "\"_rows\"";
+        exprs += "COUNT(*) AS \"_rows\"";
+        for (const auto& a : v.aggregates) {
+            const std::string in = a.column.empty() ? "*" : quoteIdentifier(a.column);
+            cols += ", " + quoteIdentifier(a.as);
+            exprs += ", " + aggregateToString(a.fn) + "(" + in + ")";
+            if (a.fn == Aggregate::SUM) {
+                cols += ", " + quoteIdentifier("_n_" + a.as);
+                exprs += ", COUNT(" + in + ")";
+            }
+        }
+
+        std::string select = "SELECT " + exprs + " FROM " + quoteIdentifier(v.base);
+        if (!groups.empty()) select += " GROUP BY " + groups;
+        else select = "SELECT * FROM (" + select + ") WHERE \"_rows\" > 0"; // No row for an empty table
+
+        return {
+            "DELETE FROM " + quoteIdentifier(name) + ";",
+            "INSERT INTO " + quoteIdentifier(name) + " (" + cols + ") " + select + ";"
+        };
+    }
+
+    // Created once and kept for the context's lifetime, so the pointer stays valid
+    // after the lock is released
+    MetricsRegistry* metricsRegistry() {
+        ContextLock lock(ctx->mtx, "Database::metricsRegistry");
+        return ctx->metricsStore.get();
+    }
+
 public:
     Database(const std::string& filename, const Config& config = {}) {
         ctx = std::make_shared<DBContext>(filename, config);
     }
 
-    // Default destructor is fine now, shared_ptr handles cleanup
-    ~Database() = default;
+    // Delivers outstanding change events while the tables subscribers may touch still
+    // exist; everything else is released by the shared_ptr
+    ~Database() {
+        if (!ctx) return;
+        std::unique_ptr<ChangeFeed> feed;
+        {
+            ContextLock lock(ctx->mtx, "Database::~Database");
+            if (ctx->changeFeedListener) ctx->removeHookListener(ctx->changeFeedListener);
+#if defined(SQLITE_ENABLE_PREUPDATE_HOOK)
+            sqlite3_preupdate_hook(ctx->db, nullptr, nullptr);
+#endif
+            ctx->changeFeedListener = 0;
+            feed = std::move(ctx->changeFeed);
+        }
+    }
 
     // Start defining a new table
     Table& defineTable(const std::string& name) {
-        std::lock_guard<std::mutex> lock(ctx->mtx);
+        ContextLock lock(ctx->mtx, "Database::defineTable");
         // Construct table in map using piecewise construction
         // Use operator[] or emplace. 
         // We need to pass the shared_ptr context to the Table constructor.
@@ -806,7 +4441,7 @@ public:
 
     // Retrieve an existing table wrapper
     Table& getTable(const std::string& name) {
-        std::lock_guard<std::mutex> lock(ctx->mtx);
+        ContextLock lock(ctx->mtx, "Database::getTable");
         auto it = tables.find(name);
         if (it == tables.end()) {
             throw std::runtime_error("Table not defined in wrapper: " + name);
@@ -818,7 +4453,7 @@ public:
     // ORM Helper: Select directly from Database using Struct type to identify Table
     template<typename T>
     std::vector<T> query(const std::vector<Condition>& where = {}, const QueryOptions& opts = {}) {
-        return getTable(ORM<T>::table).query<T>(where, opts);
+        return getTable(ORM<T>::table).template query<T>(where, opts);
     }
 
     template<typename T>
@@ -826,11 +4461,890 @@ public:
         return getTable(ORM<T>::table).insert(obj);
     }
 
+    // Validation pass over every table in the database file (not only those defined
+    // through this wrapper): lists foreign keys whose child columns are unindexed.
+    std::vector<UnindexedForeignKey> validateForeignKeyIndexes() {
+        ContextLock lock(ctx->mtx, "Database::validateForeignKeyIndexes");
+        std::vector<UnindexedForeignKey> missing;
+        for (const auto& r : queryText(ctx->db, "SELECT name FROM sqlite_master WHERE type = 'table' AND name NOT LIKE 'sqlite_%';")) {
+            auto found = findUnindexedForeignKeys(ctx->db, r[0]);
+            missing.insert(missing.end(), found.begin(), found.end());
+        }
+        return missing;
+    }
+
+    // ==========================================
+    // Storage Settings
+    // ==========================================
+
+    // Current value of a PRAGMA, e.g. pragma("page_size") or pragma("journal_mode")
+    std::string pragma(const std::string& name) {
+        ContextLock lock(ctx->mtx, "Database::pragma");
+        auto rows = queryText(ctx->db, "PRAGMA " + quoteIdentifier(name) + ";");
+        return rows.empty() || rows[0].empty() ? std::string() : rows[0][0];
+    }
+
+    // Returns up to 'pages' free pages (0 = all) to the file system. Only does anything
+    // in a database created with AutoVacuum::INCREMENTAL. Returns the pages released.
+    long long incrementalVacuum(int pages = 0) {
+        ContextLock lock(ctx->mtx, "Database::incrementalVacuum");
+        auto freePages = [&] { return std::stoll(queryText(ctx->db, "PRAGMA freelist_count;").at(0).at(0)); };
+        long long before = freePages();
+        queryText(ctx->db, "PRAGMA incremental_vacuum(" + std::to_string(std::max(pages, 0)) + ");");
+        return before - freePages();
+    }
+
+    // ==========================================
+    // Operation Metrics
+    // ==========================================
+
+    // Starts recording insert/select/update/remove/commit latencies, per phase, into
+    // HDR-style histograms (also Config::enableMetrics). Recording costs a few clock
+    // reads per call and takes no shared lock; disabled, it is one atomic load.
+    void enableMetrics() {
+        ContextLock lock(ctx->mtx, "Database::enableMetrics");
+        if (!ctx->metricsStore) ctx->metricsStore = std::make_unique<MetricsRegistry>();
+        ctx->metrics.store(ctx->metricsStore.get(), std::memory_order_release);
+    }
+
+    // Stops recording; what was recorded stays readable
+    void disableMetrics() {
+        ctx->metrics.store(nullptr, std::memory_order_release);
+    }
+
+    // All threads' recordings merged (empty if metrics were never enabled). The merge
+    // runs outside the connection lock.
+    MetricsSnapshot metricsSnapshot() {
+        MetricsRegistry* registry = metricsRegistry();
+        return registry ? registry->snapshot() : MetricsSnapshot{};
+    }
+
+    // metricsSnapshot() in Prometheus text exposition format
+    std::string metricsText() {
+        return metricsSnapshot().text();
+    }
+
+    void resetMetrics() {
+        if (MetricsRegistry* registry = metricsRegistry()) registry->reset();
+    }
+
+    // ==========================================
+    // Lock Contention
+    // ==========================================
+
+    // How often Table/Database calls on this connection had to wait for each other, for
+    // how long, and how long each call site held the lock. Doesn't take the connection
+    // lock, so it can be polled from any thread while a long operation runs.
+    LockStats lockStats() const {
+        return ctx->mtx.stats();
+    }
+
+    void resetLockStats() {
+        ctx->mtx.resetStats();
+    }
+
+    // ==========================================
+    // Query Cancellation
+    // ==========================================
+
+    // Stops the statement running on this connection now (sqlite3_interrupt). Doesn't
+    // take the connection lock, so a watchdog thread can abort a call that holds it.
+    // An interrupted read throws QueryCancelled; an interrupted write fails, and inside
+    // an explicit transaction SQLite rolls the transaction back.
+    void interrupt() {
+        sqlite3_interrupt(ctx->db);
+    }
+
+    // Reads stopped by QueryOptions::timeout / Config::queryTimeoutMs, cancellation tokens
+    // or interrupt(), and the connection time they used. Read without the lock.
+    CancellationStats cancellationStats() const {
+        CancellationStats st;
+        st.timeouts = ctx->timeouts.load(std::memory_order_relaxed);
+        st.cancellations = ctx->cancellations.load(std::memory_order_relaxed);
+        st.lostNanos = ctx->lostNanos.load(std::memory_order_relaxed);
+        st.maxLostNanos = ctx->maxLostNanos.load(std::memory_order_relaxed);
+        return st;
+    }
+
+    void resetCancellationStats() {
+        ctx->timeouts = 0;
+        ctx->cancellations = 0;
+        ctx->lostNanos = 0;
+        ctx->maxLostNanos = 0;
+    }
+
+    // ==========================================
+    // WAL Checkpointing
+    // ==========================================
+
+    // Moves WAL checkpoints off the write path: disables SQLite's automatic checkpoint on
+    // this connection and runs them on a background thread with its own connection, PASSIVE
+    // every opts.interval and escalated when the WAL log outgrows opts.walBudgetBytes.
+    // Unless the escalation is TRUNCATE, journal_size_limit is set to the budget so a
+    // restarted WAL does not keep its peak size on disk. An escalated checkpoint briefly
+    // holds the write lock, so this connection waits up to opts.busyTimeout for it (or its
+    // own busy timeout, if longer), polling finely, instead of failing with "database is
+    // locked". Requires a file database in WAL mode. Calling it again restarts with new
+    // options.
+    void startCheckpointer(const CheckpointOptions& opts = {}) {
+        ContextLock lock(ctx->mtx, "Database::startCheckpointer");
+        auto mode = queryText(ctx->db, "PRAGMA journal_mode;");
+        if (mode.empty() || mode[0][0] != "wal") {
+            throw std::runtime_error("Background checkpointing requires journal_mode = WAL");
+        }
+        const char* path = sqlite3_db_filename(ctx->db, "main");
+        if (!path || !*path) {
+            throw std::runtime_error("Background checkpointing requires a file database");
+        }
+
+        if (!ctx->checkpointer) {
+            ctx->savedAutocheckpoint = std::stoi(queryText(ctx->db, "PRAGMA wal_autocheckpoint;").at(0).at(0));
+            ctx->savedBusyTimeout = std::stoi(queryText(ctx->db, "PRAGMA busy_timeout;").at(0).at(0));
+            ctx->savedJournalSizeLimit = std::stoll(queryText(ctx->db, "PRAGMA journal_size_limit;").at(0).at(0));
+        }
+        ctx->checkpointer.reset();
+        ctx->checkpointer = std::make_unique<CheckpointManager>(path, opts);
+        sqlite3_wal_autocheckpoint(ctx->db, 0);
+        int64_t sizeLimit = opts.escalation == CheckpointMode::TRUNCATE ? ctx->savedJournalSizeLimit
+                                                                        : std::max<int64_t>(0, opts.walBudgetBytes);
+        execOrThrow(ctx->db, "PRAGMA journal_size_limit = " + std::to_string(sizeLimit) + ";",
+                    "Failed to set journal_size_limit");
+        ctx->checkpointBusyMs = std::max(static_cast<int>(opts.busyTimeout.count()), ctx->savedBusyTimeout);
+        sqlite3_busy_handler(ctx->db, &CheckpointManager::busyWait, &ctx->checkpointBusyMs);
+    }
+
+    // Stops the background thread and restores the connection's automatic checkpoints
+    void stopCheckpointer() {
+        ContextLock lock(ctx->mtx, "Database::stopCheckpointer");
+        if (!ctx->checkpointer) return;
+        ctx->checkpointer.reset();
+        sqlite3_wal_autocheckpoint(ctx->db, ctx->savedAutocheckpoint);
+        sqlite3_busy_timeout(ctx->db, ctx->savedBusyTimeout);
+        execOrThrow(ctx->db, "PRAGMA journal_size_limit = " + std::to_string(ctx->savedJournalSizeLimit) + ";",
+                    "Failed to restore journal_size_limit");
+    }
+
+    CheckpointStats checkpointStats() {
+        ContextLock lock(ctx->mtx, "Database::checkpointStats");
+        return ctx->checkpointer ? ctx->checkpointer->stats() : CheckpointStats{};
+    }
+
+    // ==========================================
+    // Backup & Snapshots
+    // ==========================================
+
+    // Copies the database to 'path' while it stays in use, 'pagesPerStep' pages at a time
+    // (-1 = all at once). The connection is only locked during each step and released for
+    // 'sleepBetweenSteps', so writers keep going; their changes are carried into the copy.
+    // A write from another connection makes SQLite restart the copy, which shows up as
+    // 'restarts'. 'progress' is called after every step. An existing file at 'path' is
+    // overwritten.
+    BackupStats backupTo(const std::string& path, int pagesPerStep = 256,
+                         std::chrono::milliseconds sleepBetweenSteps = std::chrono::milliseconds(10),
+                         BackupProgress progress = nullptr) {
+        auto start = std::chrono::steady_clock::now();
+        sqlite3* raw = nullptr;
+        int rc = sqlite3_open(path.c_str(), &raw);
+        std::unique_ptr<sqlite3, decltype(&sqlite3_close)> dest(raw, &sqlite3_close);
+        if (rc != SQLITE_OK) {
+            throw std::runtime_error("Backup failed to open " + path + ": " + (raw ? sqlite3_errmsg(raw) : "out of memory"));
+        }
+
+        sqlite3_backup* backup = nullptr;
+        {
+            ContextLock lock(ctx->mtx, "Database::backupTo");
+            backup = sqlite3_backup_init(dest.get(), "main", ctx->db, "main");
+        }
+        if (!backup) {
+            throw std::runtime_error("Backup init failed: " + std::string(sqlite3_errmsg(dest.get())));
+        }
+
+        BackupStats stats;
+        int lastRemaining = -1;
+        while (true) {
+            int remaining, total;
+            {
+                ContextLock lock(ctx->mtx, "Database::backupTo");
+                rc = sqlite3_backup_step(backup, pagesPerStep);
+                remaining = sqlite3_backup_remaining(backup);
+                total = sqlite3_backup_pagecount(backup);
+            }
+            stats.steps++;
+            if (lastRemaining >= 0 && remaining > lastRemaining) stats.restarts++;
+            lastRemaining = remaining;
+            if (progress) progress(remaining, total);
+
+            if (rc == SQLITE_DONE) {
+                stats.pages = total;
+                break;
+            }
+            if (rc != SQLITE_OK && rc != SQLITE_BUSY && rc != SQLITE_LOCKED) break;
+            if (sleepBetweenSteps.count() > 0) std::this_thread::sleep_for(sleepBetweenSteps);
+        }
+
+        {
+            ContextLock lock(ctx->mtx, "Database::backupTo");
+            sqlite3_backup_finish(backup);
+        }
+        if (rc != SQLITE_DONE) {
+            throw std::runtime_error("Backup to " + path + " failed: " + std::string(sqlite3_errstr(rc)));
+        }
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return stats;
+    }
+
+    // Consistent in-memory copy of the database, with this Database's table definitions.
+    // Copied in one step, so writers on this connection wait for it.
+    std::unique_ptr<Database> snapshotToMemory() {
+        auto snap = std::make_unique<Database>(":memory:");
+        ContextLock lock(ctx->mtx, "Database::snapshotToMemory");
+
+        // An in-memory destination cannot change its page size during the copy
+        auto pageSize = queryText(ctx->db, "PRAGMA page_size;");
+        execOrThrow(snap->ctx->db, "PRAGMA page_size = " + pageSize.at(0).at(0) + ";", "Snapshot failed to set page size");
+
+        sqlite3_backup* backup = sqlite3_backup_init(snap->ctx->db, "main", ctx->db, "main");
+        if (!backup) {
+            throw std::runtime_error("Snapshot failed: " + std::string(sqlite3_errmsg(snap->ctx->db)));
+        }
+        int rc = sqlite3_backup_step(backup, -1);
+        sqlite3_backup_finish(backup);
+        if (rc != SQLITE_DONE) {
+            throw std::runtime_error("Snapshot failed: " + std::string(sqlite3_errstr(rc)));
+        }
+
+        for (const auto& [name, table] : tables) {
+            snap->tables.emplace(std::piecewise_construct, std::forward_as_tuple(name), std::forward_as_tuple(table, snap->ctx));
+        }
+        return snap;
+    }
+
+    // Contiguous image of the database file, e.g. to clone a warm fixture with fromImage().
+    // WAL-mode images are marked as rollback-journal images, which is what in-memory
+    // databases can open.
+    DatabaseImage serialize() {
+        ContextLock lock(ctx->mtx, "Database::serialize");
+        sqlite3_int64 size = 0;
+        auto image = std::make_shared<std::vector<unsigned char>>();
+        if (unsigned char* data = sqlite3_serialize(ctx->db, "main", &size, SQLITE_SERIALIZE_NOCOPY)) {
+            image->assign(data, data + size); // In-memory database: no intermediate copy
+        } else if (unsigned char* copy = sqlite3_serialize(ctx->db, "main", &size, 0)) {
+            image->assign(copy, copy + size);
+            sqlite3_free(copy);
+        } else if (size != 0) {
+            throw std::runtime_error("Serialize failed: " + std::string(sqlite3_errmsg(ctx->db)));
+        }
+        if (image->size() >= 20 && (*image)[18] == 2) {
+            (*image)[18] = 1; // File format write/read versions: 2 = WAL, 1 = legacy
+            (*image)[19] = 1;
+        }
+        return image;
+    }
+
+    // Opens an in-memory database on 'image'. Read-only databases read the image in place
+    // (no copy) and keep it alive until they close; writable ones get a private copy that
+    // grows as needed. Tables must be looked up with defineTable (without create()).
+    static std::unique_ptr<Database> fromImage(DatabaseImage image, bool readOnly = true, const Config& config = {}) {
+        if (!image) throw std::invalid_argument("fromImage: null image");
+        auto db = std::make_unique<Database>(":memory:", config);
+        ContextLock lock(db->ctx->mtx, "Database::fromImage");
+
+        sqlite3_int64 size = static_cast<sqlite3_int64>(image->size());
+        unsigned char* data;
+        unsigned flags;
+        if (readOnly) {
+            data = const_cast<unsigned char*>(image->data()); // SQLite never writes a READONLY image
+            flags = SQLITE_DESERIALIZE_READONLY;
+            db->ctx->image = image;
+        } else {
+            data = static_cast<unsigned char*>(sqlite3_malloc64(size > 0 ? size : 1));
+            if (!data) throw std::bad_alloc();
+            if (size > 0) std::memcpy(data, image->data(), static_cast<size_t>(size));
+            flags = SQLITE_DESERIALIZE_FREEONCLOSE | SQLITE_DESERIALIZE_RESIZEABLE;
+        }
+        int rc = sqlite3_deserialize(db->ctx->db, "main", data, size, size, flags); // Frees 'data' on failure
+        if (rc != SQLITE_OK) {
+            throw std::runtime_error("Deserialize failed: " + std::string(sqlite3_errstr(rc)));
+        }
+        return db;
+    }
+
+    // Writes a compacted, defragmented copy of the database to 'path' (VACUUM INTO).
+    // The copy is made in a single statement, so this connection is busy until it is
+    // done. Fails if 'path' exists and is not empty.
+    void vacuumInto(const std::string& path) {
+        ContextLock lock(ctx->mtx, "Database::vacuumInto");
+        queryText(ctx->db, "VACUUM INTO ?;", {path});
+    }
+
+    // ==========================================
+    // Result Cache
+    // ==========================================
+
+    // Enables caching of select() calls made with QueryOptions::cache = true. Writes to
+    // any table an entry read (its base table and joins) drop the entry via the update
+    // hook, a rollback drops everything, and entries expire after 'defaultTtl' unless the
+    // query sets cacheTtl. Queries reading a WITHOUT ROWID table or a view are never
+    // cached, since the update hook does not report their writes. Tables referenced only
+    // inside raw SQL fragments (column expressions, join conditions) are not tracked, and
+    // neither are writes made by other connections; give such queries a short TTL.
+    void enableResultCache(size_t maxBytes = 64 << 20, std::chrono::milliseconds defaultTtl = std::chrono::hours(1)) {
+        ContextLock lock(ctx->mtx, "Database::enableResultCache");
+        if (ctx->resultCacheListener) ctx->removeHookListener(ctx->resultCacheListener);
+        ctx->resultCache = std::make_unique<ResultCache>(maxBytes, defaultTtl);
+
+        ResultCache* cache = ctx->resultCache.get();
+        DBContext::HookListener listener;
+        listener.onUpdate = [cache](int, const char* table, sqlite3_int64) { cache->invalidateTable(table); };
+        listener.onRollback = [cache]() { cache->clear(); };
+        ctx->resultCacheListener = ctx->addHookListener(std::move(listener));
+    }
+
+    void disableResultCache() {
+        ContextLock lock(ctx->mtx, "Database::disableResultCache");
+        if (ctx->resultCacheListener) ctx->removeHookListener(ctx->resultCacheListener);
+        ctx->resultCacheListener = 0;
+        ctx->resultCache.reset();
+    }
+
+    ResultCache::Stats resultCacheStats() {
+        ContextLock lock(ctx->mtx, "Database::resultCacheStats");
+        return ctx->resultCache ? ctx->resultCache->stats() : ResultCache::Stats{};
+    }
+
+    // ==========================================
+    // Change Data Capture
+    // ==========================================
+
+    // Calls 'callback' on a background thread with the changes each committed
+    // transaction made to 'table' on this connection: inserts, updates and deletes by
+    // rowid, in order, with repeated changes to one row within the transaction merged
+    // into a single event. With opts.values the events also carry the old/new column
+    // values, which needs SQLite built with SQLITE_ENABLE_PREUPDATE_HOOK (CMake option
+    // SQLDB_PREUPDATE_HOOK). Changes undone by ROLLBACK TO a savepoint, made by other
+    // connections, or to WITHOUT ROWID tables are not reported. Callbacks may use the
+    // database; they must not call flushSubscriptions().
+    size_t subscribe(const std::string& table, ChangeCallback callback, const SubscribeOptions& opts = {}) {
+#if !defined(SQLITE_ENABLE_PREUPDATE_HOOK)
+        if (opts.values) {
+            throw std::runtime_error("Change values require SQLite built with SQLITE_ENABLE_PREUPDATE_HOOK");
+        }
+#endif
+        ContextLock lock(ctx->mtx, "Database::subscribe");
+        std::vector<std::string> columns;
+        for (const auto& r : queryText(ctx->db, "SELECT name FROM pragma_table_info(?);", {table})) {
+            columns.push_back(r[0]);
+        }
+        if (columns.empty()) {
+            throw std::runtime_error("Cannot subscribe to unknown table: " + table);
+        }
+
+        if (!ctx->changeFeed) ctx->changeFeed = std::make_unique<ChangeFeed>();
+        ChangeFeed* feed = ctx->changeFeed.get();
+        if (!feed->hasSubscribers()) {
+            DBContext::HookListener listener;
+#if defined(SQLITE_ENABLE_PREUPDATE_HOOK)
+            sqlite3_preupdate_hook(ctx->db, &DBContext::preupdateHook, ctx.get());
+#else
+            listener.onUpdate = [feed](int op, const char* t, sqlite3_int64 rowid) { feed->record(op, t, rowid); };
+#endif
+            listener.onCommit = [feed, c = ctx.get()]() {
+                if (feed->stage()) c->mtx.onNextUnlock(&DBContext::confirmCommit, c);
+            };
+            listener.onRollback = [feed]() { feed->rollback(); };
+            ctx->changeFeedListener = ctx->addHookListener(std::move(listener));
+        }
+        ctx->trackDeletes(asciiLower(table));
+        return feed->subscribe(table, opts.values, std::move(columns), std::move(callback));
+    }
+
+    void unsubscribe(size_t id) {
+        ContextLock lock(ctx->mtx, "Database::unsubscribe");
+        if (!ctx->changeFeed || !ctx->changeFeed->unsubscribe(id)) return;
+        if (!ctx->changeFeed->hasSubscribers()) {
+            // Stop capturing; the consumer thread stays parked until the Database closes
+#if defined(SQLITE_ENABLE_PREUPDATE_HOOK)
+            sqlite3_preupdate_hook(ctx->db, nullptr, nullptr);
+#endif
+            ctx->removeHookListener(ctx->changeFeedListener);
+            ctx->changeFeedListener = 0;
+        }
+    }
+
+    // Blocks until every change committed so far has been handed to the subscribers
+    void flushSubscriptions() {
+        ChangeFeed* feed;
+        {
+            ContextLock lock(ctx->mtx, "Database::flushSubscriptions");
+            feed = ctx->changeFeed.get();
+        }
+        if (feed) feed->flush();
+    }
+
+    ChangeFeed::Stats changeFeedStats() {
+        ContextLock lock(ctx->mtx, "Database::changeFeedStats");
+        return ctx->changeFeed ? ctx->changeFeed->stats() : ChangeFeed::Stats{};
+    }
+
+    // ==========================================
+    // Materialized Views
+    // ==========================================
+
+    // Creates (if missing) a summary table 'name' holding one row per distinct 'groupBy'
+    // value of 'baseTable' with the given COUNT/SUM/MIN/MAX aggregates, and installs
+    // triggers that update it on every insert, update and delete of the base table, in the
+    // same transaction. Reads are then a plain select on the returned Table. Besides the
+    // group and aggregate columns the table has "_rows" (COUNT(*) of the group) and, per
+    // SUM, a "_n_<as>" count of non-NULL inputs. Deleting or updating the current MIN/MAX of
+    // a group re-scans that group, so index the base table's group columns. Call on every
+    // open, like defineTable; the triggers are regenerated from this definition.
+    Table& defineMaterializedView(const std::string& name, const std::string& baseTable,
+                                  const std::vector<std::string>& groupBy, std::vector<ViewAggregate> aggregates) {
+        std::map<std::string, SQLType> baseTypes;
+        {
+            ContextLock lock(ctx->mtx, "Database::defineMaterializedView");
+            for (const auto& r : queryText(ctx->db, "SELECT name, type FROM pragma_table_info(?);", {baseTable})) {
+                baseTypes[r[0]] = declTypeToSQLType(r[1]);
+            }
+        }
+        if (baseTypes.empty()) {
+            throw std::runtime_error("Materialized view base table not found: " + baseTable);
+        }
+        auto typeOf = [&](const std::string& col) {
+            auto it = baseTypes.find(col);
+            if (it == baseTypes.end()) throw std::runtime_error("Materialized view column not in " + baseTable + ": " + col);
+            return it->second;
+        };
+
+        for (auto& a : aggregates) {
+            if (a.column == "*") a.column.clear();
+            if (a.fn == Aggregate::AVG) {
+                throw std::runtime_error("Materialized views maintain COUNT/SUM/MIN/MAX; derive AVG from SUM and COUNT");
+            }
+            if (a.column.empty() && a.fn != Aggregate::COUNT) {
+                throw std::runtime_error("Materialized view " + aggregateToString(a.fn) + " needs a column");
+            }
+            if (a.as.empty()) {
+                std::string fn = aggregateToString(a.fn);
+                std::transform(fn.begin(), fn.end(), fn.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                a.as = a.column.empty() ? fn : fn + "_" + a.column;
+            }
+        }
+
+        Table& view = defineTable(name);
+        for (const auto& g : groupBy) view.addColumn(g, typeOf(g));
+        view.addColumn("_rows", SQLType::INTEGER);
+        for (const auto& a : aggregates) {
+            SQLType type = a.fn == Aggregate::COUNT ? SQLType::INTEGER : typeOf(a.column);
+            view.addColumn(a.as, type);
+            if (a.fn == Aggregate::SUM) view.addColumn("_n_" + a.as, SQLType::INTEGER);
+        }
+
+        MaterializedView def{baseTable, groupBy, aggregates};
+        ContextLock lock(ctx->mtx, "Database::defineMaterializedView");
+        bool exists = !queryText(ctx->db, "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?;", {name}).empty();
+
+        std::vector<std::string> ddl;
+        if (!exists) {
+            std::string cols;
+            for (const auto& col : view.getColumns()) {
+                if (!cols.empty()) cols += ", ";
+                cols += quoteIdentifier(col.name) + " " + typeToString(col.type);
+            }
+            ddl.push_back("CREATE TABLE " + quoteIdentifier(name) + " (" + cols + ");");
+            if (!groupBy.empty()) {
+                std::string keys;
+                for (const auto& g : groupBy) keys += (keys.empty() ? "" : ", ") + quoteIdentifier(g);
+                ddl.push_back("CREATE UNIQUE INDEX IF NOT EXISTS " + quoteIdentifier("idx_" + name + "_group") + " ON "
+                              + quoteIdentifier(name) + " (" + keys + ");");
+            }
+        }
+        for (const auto& sql : materializedViewTriggers(name, def)) ddl.push_back(sql);
+        if (!exists) {
+            for (const auto& sql : materializedViewRebuild(name, def)) ddl.push_back(sql);
+        }
+        runAtomically(ddl, "Materialized view " + name);
+
+        views[name] = std::move(def);
+        return view;
+    }
+
+    // Recomputes a materialized view from its base table, e.g. after the triggers were
+    // missing while the base table changed, or to clear floating-point drift in SUMs
+    void rebuildMaterializedView(const std::string& name) {
+        ContextLock lock(ctx->mtx, "Database::rebuildMaterializedView");
+        auto it = views.find(name);
+        if (it == views.end()) {
+            throw std::runtime_error("Materialized view not defined: " + name);
+        }
+        runAtomically(materializedViewRebuild(name, it->second), "Rebuild of materialized view " + name);
+    }
+
+    // Removes the triggers and the summary table
+    void dropMaterializedView(const std::string& name) {
+        ContextLock lock(ctx->mtx, "Database::dropMaterializedView");
+        std::vector<std::string> ddl;
+        for (const char* suffix : {"_ins", "_upd", "_del"}) {
+            ddl.push_back("DROP TRIGGER IF EXISTS " + quoteIdentifier("_sqldb_mv_" + name + suffix) + ";");
+        }
+        ddl.push_back("DROP TABLE IF EXISTS " + quoteIdentifier(name) + ";");
+        runAtomically(ddl, "Drop of materialized view " + name);
+        views.erase(name);
+        tables.erase(name);
+    }
+
+    // ==========================================
+    // Bulk Loading
+    // ==========================================
+
+    // Loads rows pulled from 'source' (returns false when exhausted) into 'table'.
+    // The table's secondary indexes are dropped for the duration and rebuilt once at
+    // the end, durability is relaxed (synchronous = OFF, large cache), and rows are
+    // committed in batches of opts.batchSize. Returns the number of rows inserted.
+    //
+    // The dropped index definitions are recorded in _sqldb_bulkload in the same
+    // transaction that drops them. If the process dies midway, every fully committed
+    // batch is kept and recoverBulkLoad() recreates the missing indexes.
+    size_t bulkLoad(Table& table, const std::function<bool(Row&)>& source, const BulkLoadOptions& opts = {}) {
+        if (opts.disableJournal && !opts.acceptPartialBatch) {
+            throw std::invalid_argument("bulkLoad: disableJournal requires acceptPartialBatch (a failed batch can't be rolled back)");
+        }
+        const std::string& name = table.getName();
+        std::vector<std::pair<std::string, std::string>> indexes; // name, CREATE INDEX sql
+
+        // Puts the connection settings back on every exit path, including a failed index
+        // rebuild. Declared before the lock below so it runs after that lock is released.
+        struct SettingsGuard {
+            Database& db;
+            bool disableJournal;
+            bool armed = false;
+            std::string journalMode{}, syncMode{}, cacheSize{};
+
+            ~SettingsGuard() {
+                if (!armed) return;
+                ContextLock lock(db.ctx->mtx, "Database::bulkLoad");
+                if (disableJournal) {
+                    sqlite3_exec(db.ctx->db, ("PRAGMA journal_mode = " + journalMode + ";").c_str(), nullptr, nullptr, nullptr);
+                }
+                sqlite3_exec(db.ctx->db, ("PRAGMA synchronous = " + syncMode + ";").c_str(), nullptr, nullptr, nullptr);
+                sqlite3_exec(db.ctx->db, ("PRAGMA cache_size = " + cacheSize + ";").c_str(), nullptr, nullptr, nullptr);
+            }
+        } settings{*this, opts.disableJournal};
+
+        {
+            ContextLock lock(ctx->mtx, "Database::bulkLoad");
+            if (!sqlite3_get_autocommit(ctx->db)) {
+                throw std::runtime_error("Bulk load failed: cannot run inside a transaction");
+            }
+            settings.journalMode = queryText(ctx->db, "PRAGMA journal_mode;")[0][0];
+            settings.syncMode = queryText(ctx->db, "PRAGMA synchronous;")[0][0];
+            settings.cacheSize = queryText(ctx->db, "PRAGMA cache_size;")[0][0];
+
+            // Indexes backing PRIMARY KEY / UNIQUE column constraints have no sql and stay
+            for (const auto& r : queryText(ctx->db, "SELECT name, sql FROM sqlite_master WHERE type = 'index' AND tbl_name = ? AND sql IS NOT NULL;", {name})) {
+                indexes.emplace_back(r[0], r[1]);
+            }
+
+            execOrThrow(ctx->db, "CREATE TABLE IF NOT EXISTS _sqldb_bulkload (idx_name TEXT PRIMARY KEY, tbl_name TEXT, sql TEXT);", "Bulk load failed");
+            execOrThrow(ctx->db, "BEGIN;", "Bulk load failed to drop indexes of " + name);
+            try {
+                for (const auto& [idxName, idxSql] : indexes) {
+                    queryText(ctx->db, "INSERT OR REPLACE INTO _sqldb_bulkload VALUES (?, ?, ?);", {idxName, name, idxSql});
+                    execOrThrow(ctx->db, "DROP INDEX " + quoteIdentifier(idxName) + ";", "Bulk load failed to drop index " + idxName);
+                }
+                execOrThrow(ctx->db, "COMMIT;", "Bulk load failed to drop indexes of " + name);
+            } catch (...) {
+                sqlite3_exec(ctx->db, "ROLLBACK;", nullptr, nullptr, nullptr);
+                throw;
+            }
+
+            settings.armed = true;
+            sqlite3_exec(ctx->db, "PRAGMA synchronous = OFF;", nullptr, nullptr, nullptr);
+            sqlite3_exec(ctx->db, ("PRAGMA cache_size = " + std::to_string(-opts.cacheSizeKiB) + ";").c_str(), nullptr, nullptr, nullptr);
+            if (opts.disableJournal) {
+                sqlite3_exec(ctx->db, "PRAGMA journal_mode = OFF;", nullptr, nullptr, nullptr);
+            }
+        }
+
+        auto rebuildIndexes = [&]() {
+            ContextLock lock(ctx->mtx, "Database::bulkLoad");
+            execOrThrow(ctx->db, "BEGIN;", "Bulk load failed to rebuild indexes of " + name);
+            try {
+                for (const auto& [idxName, idxSql] : indexes) {
+                    execOrThrow(ctx->db, idxSql + ";", "Bulk load failed to rebuild index " + idxName);
+                }
+                queryText(ctx->db, "DELETE FROM _sqldb_bulkload WHERE tbl_name = ?;", {name});
+                execOrThrow(ctx->db, "COMMIT;", "Bulk load failed to rebuild indexes of " + name);
+            } catch (...) {
+                sqlite3_exec(ctx->db, "ROLLBACK;", nullptr, nullptr, nullptr);
+                throw;
+            }
+        };
+
+        size_t loaded = 0;
+        try {
+            Row row;
+            bool more = true;
+            while (more) {
+                auto txn = transaction();
+                size_t inBatch = 0;
+                while (inBatch < opts.batchSize && (more = source(row))) {
+                    table.insert(row);
+                    row.clear();
+                    ++inBatch;
+                }
+                txn.commit();
+                loaded += inBatch;
+            }
+        } catch (...) {
+            try { rebuildIndexes(); } catch (...) {
+                // Keep the original error; _sqldb_bulkload still lists the indexes
+            }
+            throw;
+        }
+        // A failed rebuild (e.g. UNIQUE violated by the loaded rows) throws; the dropped
+        // indexes stay listed in _sqldb_bulkload and the settings are restored regardless
+        rebuildIndexes();
+        return loaded;
+    }
+
+    size_t bulkLoad(Table& table, const std::vector<Row>& rows, const BulkLoadOptions& opts = {}) {
+        size_t next = 0;
+        return bulkLoad(table, [&](Row& row) {
+            if (next >= rows.size()) return false;
+            row = rows[next++];
+            return true;
+        }, opts);
+    }
+
+    // Recreates indexes left dropped by a bulkLoad that did not finish (crash or kill).
+    // Safe to call on every startup; returns the number of indexes rebuilt.
+    size_t recoverBulkLoad() {
+        ContextLock lock(ctx->mtx, "Database::recoverBulkLoad");
+        auto exists = queryText(ctx->db, "SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = '_sqldb_bulkload';");
+        if (exists.empty()) return 0;
+
+        auto pending = queryText(ctx->db, "SELECT idx_name, sql FROM _sqldb_bulkload;");
+        execOrThrow(ctx->db, "BEGIN;", "Bulk load recovery failed");
+        try {
+            for (const auto& r : pending) {
+                std::string sql = r[1];
+                // CREATE [UNIQUE] INDEX name -> CREATE [UNIQUE] INDEX IF NOT EXISTS name
+                size_t pos = sql.find("INDEX");
+                if (pos != std::string::npos) sql.insert(pos + 5, " IF NOT EXISTS");
+                execOrThrow(ctx->db, sql + ";", "Bulk load recovery failed for index " + r[0]);
+            }
+            execOrThrow(ctx->db, "DELETE FROM _sqldb_bulkload; COMMIT;", "Bulk load recovery failed");
+        } catch (...) {
+            sqlite3_exec(ctx->db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            throw;
+        }
+        return pending.size();
+    }
+
+    // ==========================================
+    // CSV / TSV Import
+    // ==========================================
+
+    // Streams a CSV/TSV file into 'table'. The calling thread reads the file in
+    // chunkBytes pieces cut at record boundaries; a pool of parser threads splits and
+    // converts each chunk into SQLValues typed by the table's ColumnDefs; the calling
+    // thread then writes the batches in file order through multi-row INSERTs, one
+    // transaction per batchRows rows. Any error stops the pipeline and is rethrown here;
+    // batches committed before it stay in the table.
+    ImportStats importCsv(Table& table, const std::string& path, const CsvOptions& opts = {}) {
+        auto startTime = std::chrono::steady_clock::now();
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("CSV import failed: cannot open " + path);
+
+        // Read the next chunk, ending at a record boundary; returns false at EOF
+        std::string carry;
+        bool eof = false;
+        ImportStats stats;
+        auto readChunk = [&](std::string& chunk) {
+            chunk.swap(carry);
+            carry.clear();
+            while (true) {
+                size_t old = chunk.size();
+                if (!eof) {
+                    chunk.resize(old + opts.chunkBytes);
+                    in.read(&chunk[old], static_cast<std::streamsize>(opts.chunkBytes));
+                    chunk.resize(old + static_cast<size_t>(in.gcount()));
+                    stats.bytes += static_cast<size_t>(in.gcount());
+                    eof = !in;
+                }
+                if (eof) return !chunk.empty();
+                size_t end = csvLastRecordEnd(chunk.data(), chunk.size(), opts.delimiter);
+                if (end > 0) {
+                    carry.assign(chunk, end, std::string::npos);
+                    chunk.resize(end);
+                    return true;
+                }
+                // A single record larger than the chunk: keep reading
+            }
+        };
+
+        std::string first;
+        if (!readChunk(first)) return stats;
+
+        // Resolve target columns and their declared types
+        std::vector<std::string> cols = opts.columns;
+        size_t pos = 0;
+        if (opts.header) {
+            std::vector<bool> quoted;
+            csvParseRecord(first.data(), first.size(), pos, opts.delimiter, cols, quoted);
+            first.erase(0, pos);
+        }
+        if (cols.empty()) {
+            for (const auto& c : table.getColumns()) cols.push_back(c.name);
+        }
+        std::vector<SQLType> types;
+        for (const auto& name : cols) {
+            SQLType type = SQLType::TEXT;
+            bool found = table.getColumns().empty(); // Table not described via addColumn: insert as text
+            for (const auto& c : table.getColumns()) {
+                if (c.name == name) { type = c.type; found = true; }
+            }
+            if (!found) throw std::runtime_error("CSV import failed: column " + name + " is not defined in " + table.getName());
+            types.push_back(type);
+        }
+
+        struct Batch {
+            std::vector<SQLValue> values;
+            size_t rows = 0;
+        };
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::list<std::pair<size_t, std::string>> jobs;
+        std::map<size_t, Batch> done;
+        size_t inFlight = 0;
+        bool readerDone = false;
+        bool failed = false;
+        std::exception_ptr error;
+
+        unsigned threadCount = opts.threads ? opts.threads : std::max(1u, std::thread::hardware_concurrency());
+        const size_t maxInFlight = 2 * threadCount + 2;
+
+        auto fail = [&](std::exception_ptr e) {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!error) error = e;
+            failed = true;
+            cv.notify_all();
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threadCount; ++t) {
+            workers.emplace_back([&]() {
+                std::vector<std::string> fields;
+                std::vector<bool> quoted;
+                while (true) {
+                    std::pair<size_t, std::string> job;
+                    {
+                        std::unique_lock<std::mutex> lock(mtx);
+                        cv.wait(lock, [&] { return failed || !jobs.empty() || readerDone; });
+                        if (failed || jobs.empty()) return;
+                        job = std::move(jobs.front());
+                        jobs.pop_front();
+                    }
+                    try {
+                        Batch batch;
+                        const std::string& data = job.second;
+                        size_t p = 0;
+                        while (p < data.size()) {
+                            csvParseRecord(data.data(), data.size(), p, opts.delimiter, fields, quoted);
+                            if (fields.size() == 1 && fields[0].empty() && !quoted[0]) continue; // blank line
+                            if (fields.size() != cols.size()) {
+                                throw std::runtime_error("CSV import failed: record has " + std::to_string(fields.size())
+                                                         + " fields, expected " + std::to_string(cols.size()));
+                            }
+                            for (size_t i = 0; i < fields.size(); ++i) {
+                                batch.values.push_back(csvConvertField(fields[i], quoted[i], types[i]));
+                            }
+                            ++batch.rows;
+                        }
+                        std::lock_guard<std::mutex> lock(mtx);
+                        done.emplace(job.first, std::move(batch));
+                        cv.notify_all();
+                    } catch (...) {
+                        fail(std::current_exception());
+                        return;
+                    }
+                }
+            });
+        }
+
+        std::thread reader([&]() {
+            try {
+                std::string chunk = std::move(first);
+                size_t seq = 0;
+                bool more = true;
+                while (more) {
+                    {
+                        std::unique_lock<std::mutex> lock(mtx);
+                        cv.wait(lock, [&] { return failed || inFlight < maxInFlight; });
+                        if (failed) break;
+                        jobs.emplace_back(seq++, std::move(chunk));
+                        ++inFlight;
+                        cv.notify_all();
+                    }
+                    chunk = std::string();
+                    more = readChunk(chunk);
+                }
+            } catch (...) {
+                fail(std::current_exception());
+            }
+            std::lock_guard<std::mutex> lock(mtx);
+            readerDone = true;
+            cv.notify_all();
+        });
+
+        // Single writer: consume batches in file order
+        try {
+            auto txn = std::make_unique<TransactionGuard>(*this);
+            size_t inTxn = 0;
+            for (size_t seq = 0;; ++seq) {
+                Batch batch;
+                {
+                    std::unique_lock<std::mutex> lock(mtx);
+                    cv.wait(lock, [&] { return failed || done.count(seq) || (readerDone && inFlight == 0); });
+                    if (failed) break;
+                    auto it = done.find(seq);
+                    if (it == done.end()) break; // all chunks written
+                    batch = std::move(it->second);
+                    done.erase(it);
+                    --inFlight;
+                    cv.notify_all();
+                }
+                table.insertMany(cols, batch.values, opts.rowsPerStatement);
+                stats.rows += batch.rows;
+                inTxn += batch.rows;
+                if (inTxn >= opts.batchRows) {
+                    txn->commit();
+                    txn = std::make_unique<TransactionGuard>(*this);
+                    inTxn = 0;
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (!failed) txn->commit();
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+
+        reader.join();
+        for (auto& w : workers) w.join();
+        if (error) std::rethrow_exception(error);
+
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        return stats;
+    }
+
     // ==========================================
     // Transaction Support
     // ==========================================
     void beginTransaction() {
-        std::lock_guard<std::mutex> lock(ctx->mtx);
+        ContextLock lock(ctx->mtx, "Database::beginTransaction");
         char* errMsg = nullptr;
         if (sqlite3_exec(ctx->db, "BEGIN TRANSACTION;", nullptr, nullptr, &errMsg) != SQLITE_OK) {
              std::string err = errMsg ? errMsg : "Unknown error";
@@ -840,9 +5354,13 @@ public:
     }
 
     void commit() {
-        std::lock_guard<std::mutex> lock(ctx->mtx);
+        OpTimer timer(ctx->activeMetrics(), MetricOp::COMMIT);
+        ContextLock lock(ctx->mtx, "Database::commit");
+        timer.split(MetricPhase::LOCK_WAIT);
         char* errMsg = nullptr;
-        if (sqlite3_exec(ctx->db, "COMMIT;", nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        int rc = sqlite3_exec(ctx->db, "COMMIT;", nullptr, nullptr, &errMsg);
+        timer.split(MetricPhase::STEP);
+        if (rc != SQLITE_OK) {
              std::string err = errMsg ? errMsg : "Unknown error";
              if(errMsg) sqlite3_free(errMsg);
              throw std::runtime_error("Commit failed: " + err);
@@ -850,7 +5368,7 @@ public:
     }
 
     void rollback() {
-        std::lock_guard<std::mutex> lock(ctx->mtx);
+        ContextLock lock(ctx->mtx, "Database::rollback");
         char* errMsg = nullptr;
         // Rollback shouldn't generally throw, but we report errors
         if (sqlite3_exec(ctx->db, "ROLLBACK;", nullptr, nullptr, &errMsg) != SQLITE_OK) {
@@ -15,6 +15,7 @@ int main() {
         test_orm(db);
         test_advanced(db); // Covers Joins, GroupBy, Indexing, Constraints, Blob
         test_transactions(db); // Covers Rollback/Commit explicitly
+        test_csv(db);
         test_performance(db);
 
     } catch (const std::exception& e) {
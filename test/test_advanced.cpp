@@ -1,4 +1,43 @@
 #include "test_utils.h"
+#include <cstdio>
+
+// Default VFS wrapper whose WAL writes fail while 'failing' is set, to make a COMMIT fail
+// after SQLite has already run the commit hook
+struct FaultyWrites {
+    static inline bool failing = false;
+    static inline sqlite3_vfs* real = nullptr;
+    static inline sqlite3_vfs vfs{};
+    static inline const sqlite3_io_methods* realMethods = nullptr;
+    static inline sqlite3_io_methods methods{};
+
+    static int write(sqlite3_file* file, const void* data, int amount, sqlite3_int64 offset) {
+        if (failing) return SQLITE_IOERR_WRITE;
+        return realMethods->xWrite(file, data, amount, offset);
+    }
+
+    static int open(sqlite3_vfs*, sqlite3_filename name, sqlite3_file* file, int flags, int* outFlags) {
+        int rc = real->xOpen(real, name, file, flags, outFlags);
+        if (rc == SQLITE_OK && file->pMethods && (flags & SQLITE_OPEN_WAL)) {
+            realMethods = file->pMethods;
+            methods = *file->pMethods;
+            methods.xWrite = &FaultyWrites::write;
+            file->pMethods = &methods;
+        }
+        return rc;
+    }
+
+    // Connections opened until uninstall() go through the wrapper
+    static void install() {
+        real = sqlite3_vfs_find(nullptr);
+        vfs = *real;
+        vfs.zName = "sqldb_faulty_writes";
+        vfs.pNext = nullptr;
+        vfs.xOpen = &FaultyWrites::open;
+        sqlite3_vfs_register(&vfs, 1);
+    }
+
+    static void uninstall() { sqlite3_vfs_register(real, 1); }
+};
 
 void test_advanced(Database& db) {
     std::cout << "\n=== Testing Advanced Features ===" << std::endl;
@@ -46,6 +85,354 @@ void test_advanced(Database& db) {
                   << " has " << getCol<long long>(row, "COUNT(posts.id)") << " posts." << std::endl;
     }
     
+    // Typed aggregates: same answer as the GROUP BY above, without Row maps
+    std::cout << "\n--- Typed Aggregates ---" << std::endl;
+    auto postCounts = posts.countBy<long long>("user_id");
+    long long bobPosts = 0;
+    for (const auto& [userId, n] : postCounts) {
+        if (n > 1) bobPosts = n;
+    }
+    auto scoreMax = users.max<double>("score");
+    auto noneMin = users.min<double>("score", { Condition{"username", Op::EQ, "Nobody"} });
+    if (posts.count() == 2 && bobPosts == 2
+        && posts.exists({ Condition{"title", Op::EQ, "Bob's Thoughts"} })
+        && !posts.exists({ Condition{"title", Op::EQ, "Missing"} })
+        && scoreMax && *scoreMax == 99.9 && !noneMin
+        && users.sum<double>("score", { Condition{"username", Op::EQ, "Nobody"} }) == 0.0) {
+        std::cout << "Typed Aggregates Verified." << std::endl;
+    } else {
+        std::cerr << "Typed Aggregates Failed!" << std::endl;
+    }
+
+    // Row cache: hits, invalidation on update, and on rollback
+    std::cout << "\n--- Row Cache ---" << std::endl;
+    users.enableRowCache(1 << 20, 4);
+    long long bobId = getCol<long long>(users.select({ Condition{"username", Op::EQ, "Bob"} })[0], "id");
+    users.getById(bobId);
+    auto cachedBob = users.queryById<UserStruct>(bobId);
+    users.update({ {"score", 42.0} }, { Condition{"id", Op::EQ, bobId} });
+    auto updatedBob = users.getById(bobId);
+    {
+        auto txn = db.transaction();
+        users.update({ {"score", 1.0} }, { Condition{"id", Op::EQ, bobId} });
+        users.getById(bobId); // Caches the uncommitted value
+    }
+    auto afterRollback = users.getById(bobId);
+    auto stats = users.rowCacheStats();
+    if (cachedBob && cachedBob->username == "Bob" && stats.hits == 1
+        && updatedBob && getCol<double>(*updatedBob, "score") == 42.0
+        && afterRollback && getCol<double>(*afterRollback, "score") == 42.0
+        && !users.getById(-1)) {
+        std::cout << "Row Cache Verified (hits " << stats.hits << ", misses " << stats.misses
+                  << ", invalidations " << stats.invalidations << ")." << std::endl;
+    } else {
+        std::cerr << "Row Cache Failed!" << std::endl;
+    }
+    users.update({ {"score", 99.9} }, { Condition{"id", Op::EQ, bobId} });
+    users.disableRowCache();
+
+    // A DELETE without WHERE from raw SQL (here a trigger created on another connection)
+    // must still reach the row cache, and DROP must keep working while the hook is active
+    auto& rawRows = db.defineTable("rc_raw");
+    rawRows.addColumn("id", SQLType::INTEGER, true, true).addColumn("v", SQLType::TEXT).create();
+    auto& rawCmd = db.defineTable("rc_cmd");
+    rawCmd.addColumn("id", SQLType::INTEGER, true, true).addColumn("cmd", SQLType::TEXT).create();
+    sqlite3* other = nullptr;
+    sqlite3_open("test_suite.db", &other);
+    bool triggerOk = sqlite3_exec(other, "CREATE TRIGGER rc_cmd_clear AFTER INSERT ON rc_cmd "
+                                         "BEGIN DELETE FROM rc_raw; END;", nullptr, nullptr, nullptr) == SQLITE_OK;
+    rawRows.enableRowCache(1 << 20, 4);
+    std::vector<long long> rawIds;
+    for (const char* v : {"a", "b", "c"}) rawIds.push_back(rawRows.insert({ {"v", v} }));
+    for (long long id : rawIds) rawRows.getById(id);
+    rawCmd.insert({ {"cmd", "clear"} });
+    bool rawCleared = true;
+    for (long long id : rawIds) rawCleared = rawCleared && !rawRows.getById(id);
+    // rc_cmd has no listener, so its DELETE without WHERE keeps the truncate optimization
+    // and must not disturb rc_raw's cache
+    long long keptId = rawRows.insert({ {"v", "kept"} });
+    rawRows.getById(keptId);
+    rawCmd.remove({});
+    auto kept = rawRows.getById(keptId);
+    bool untrackedCleared = rawCmd.count() == 0 && kept && getCol<std::string>(*kept, "v") == "kept";
+    db.defineMaterializedView("rc_raw_by_v", "rc_raw", {"v"}, { {Aggregate::COUNT, "*", ""} });
+    db.dropMaterializedView("rc_raw_by_v");
+    bool dropped = sqlite3_exec(other, "SELECT * FROM rc_raw_by_v;", nullptr, nullptr, nullptr) != SQLITE_OK;
+    sqlite3_close(other);
+    rawRows.disableRowCache();
+    if (triggerOk && rawCleared && untrackedCleared && dropped) {
+        std::cout << "Row Cache Raw SQL Delete Verified." << std::endl;
+    } else {
+        std::cerr << "Row Cache Raw SQL Delete Failed!" << std::endl;
+    }
+
+    // Result cache: hit, invalidation through a joined table, TTL override
+    std::cout << "\n--- Result Cache ---" << std::endl;
+    db.enableResultCache(1 << 20);
+    QueryOptions cachedGroup;
+    cachedGroup.columns = {"users.username", "COUNT(posts.id)"};
+    cachedGroup.joins.push_back({JoinType::INNER, "users", "users.id = posts.user_id"});
+    cachedGroup.groupBy.push_back("user_id");
+    cachedGroup.cache = true;
+    auto firstGroups = posts.select({}, cachedGroup);
+    auto secondGroups = posts.select({}, cachedGroup);
+    long long carolId = users.insert({ {"username", "CarolCache"} });
+    posts.insert({ {"title", "Carol 1"}, {"user_id", carolId} });
+    posts.insert({ {"title", "Carol 2"}, {"user_id", carolId} });
+    auto afterWrite = posts.select({}, cachedGroup);
+    cachedGroup.cacheTtl = std::chrono::milliseconds(1);
+    posts.select({ Condition{"user_id", Op::EQ, carolId} }, cachedGroup);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    posts.select({ Condition{"user_id", Op::EQ, carolId} }, cachedGroup);
+    auto rcStats = db.resultCacheStats();
+    if (firstGroups.size() == 1 && secondGroups.size() == 1 && afterWrite.size() == 2
+        && rcStats.hits == 1 && rcStats.invalidations >= 1 && rcStats.expirations == 1) {
+        std::cout << "Result Cache Verified (hits " << rcStats.hits << ", misses " << rcStats.misses
+                  << ", invalidations " << rcStats.invalidations << ")." << std::endl;
+    } else {
+        std::cerr << "Result Cache Failed!" << std::endl;
+    }
+    posts.remove({ Condition{"user_id", Op::EQ, carolId} });
+    users.remove({ Condition{"id", Op::EQ, carolId} });
+
+    // Joins spelled in another case than the schema still depend on the table, and
+    // WITHOUT ROWID tables (no update hook) are never served from the cache
+    auto& rcA = db.defineTable("rc_a");
+    rcA.addColumn("id", SQLType::INTEGER, true, true).addColumn("b_id", SQLType::INTEGER).create();
+    auto& rcB = db.defineTable("rc_b");
+    rcB.addColumn("id", SQLType::INTEGER, true, true).addColumn("v", SQLType::TEXT).create();
+    long long aId = rcA.insert({ {"b_id", 1} });
+    QueryOptions upperJoin;
+    upperJoin.joins.push_back({JoinType::INNER, "RC_B", "RC_B.id = rc_a.b_id"});
+    upperJoin.cache = true;
+    bool joinEmpty = rcA.select({}, upperJoin).empty();
+    rcB.insert({ {"id", 1LL}, {"v", "joined"} });
+    bool joinSeesWrite = rcA.select({}, upperJoin).size() == 1;
+
+    auto& rcKeys = db.defineTable("rc_keys");
+    rcKeys.addColumn("k", SQLType::INTEGER, true).withoutRowid().create();
+    QueryOptions cachedKeys;
+    cachedKeys.cache = true;
+    rcKeys.insert({ {"k", 1LL} });
+    size_t keysBefore = rcKeys.select({}, cachedKeys).size();
+    rcKeys.insert({ {"k", 2LL} });
+    size_t keysAfter = rcKeys.select({}, cachedKeys).size();
+    if (joinEmpty && joinSeesWrite && keysBefore == 1 && keysAfter == 2) {
+        std::cout << "Result Cache Dependencies Verified." << std::endl;
+    } else {
+        std::cerr << "Result Cache Dependencies Failed!" << std::endl;
+    }
+    rcA.remove({ Condition{"id", Op::EQ, aId} });
+    db.disableResultCache();
+
+    // Separator bytes inside string values must not let two value lists share a key
+    std::string sep(1, '\x1f');
+    auto keyA = ResultCache::makeKey("SELECT ?, ?", { Condition{"a", Op::EQ, "a" + sep + "4b"}, Condition{"b", Op::EQ, "c"} }, {});
+    auto keyB = ResultCache::makeKey("SELECT ?, ?", { Condition{"a", Op::EQ, "a"}, Condition{"b", Op::EQ, "b" + sep + "4c"} }, {});
+    if (keyA != keyB) {
+        std::cout << "Result Cache Keys Verified." << std::endl;
+    } else {
+        std::cerr << "Result Cache Keys Failed!" << std::endl;
+    }
+
+    // Change data capture: one batch per commit, coalesced per row, nothing on rollback
+    std::cout << "\n--- Change Data Capture ---" << std::endl;
+    std::vector<std::vector<ChangeEvent>> batches;
+    size_t subId = db.subscribe("posts", [&](const std::vector<ChangeEvent>& events) { batches.push_back(events); });
+    long long cdcId = 0;
+    {
+        auto txn = db.transaction();
+        cdcId = posts.insert({ {"title", "Draft"}, {"user_id", bobId} });
+        posts.update({ {"title", "Final"} }, { Condition{"id", Op::EQ, cdcId} });
+        long long tmpId = posts.insert({ {"title", "Scratch"}, {"user_id", bobId} });
+        posts.remove({ Condition{"id", Op::EQ, tmpId} });
+        txn.commit();
+    }
+    {
+        auto txn = db.transaction();
+        posts.remove({ Condition{"id", Op::EQ, cdcId} });
+    } // Rolled back
+    posts.remove({ Condition{"id", Op::EQ, cdcId} });
+    db.flushSubscriptions();
+    db.unsubscribe(subId);
+    auto feedStats = db.changeFeedStats();
+    if (batches.size() == 2 && batches[0].size() == 1 && batches[0][0].op == ChangeOp::INSERT
+        && batches[0][0].rowid == cdcId && batches[1].size() == 1 && batches[1][0].op == ChangeOp::DELETE
+        && feedStats.coalesced == 2 && feedStats.discarded == 1) {
+        std::cout << "Change Data Capture Verified." << std::endl;
+    } else {
+        std::cerr << "Change Data Capture Failed!" << std::endl;
+    }
+
+    // The commit hook fires before COMMIT has written anything, so the commit can still
+    // fail (here: the WAL write, through FaultyWrites) and roll back. Nothing may be
+    // delivered for it, while the next commit is.
+    {
+        const std::string faultFile = "cdc_fault.db";
+        for (const char* suffix : {"", "-wal", "-shm"}) std::remove((faultFile + suffix).c_str());
+        std::vector<std::vector<ChangeEvent>> faultBatches;
+        bool faultOk = false;
+        {
+            FaultyWrites::install();
+            Database fdb(faultFile);
+            FaultyWrites::uninstall();
+            auto& items = fdb.defineTable("cdc_fault");
+            items.addColumn("id", SQLType::INTEGER, true, true).addColumn("v", SQLType::TEXT).create();
+            size_t faultId = fdb.subscribe("cdc_fault", [&](const std::vector<ChangeEvent>& events) { faultBatches.push_back(events); });
+            auto fails = [&](auto&& op) {
+                FaultyWrites::failing = true;
+                bool threw = false;
+                try {
+                    op();
+                } catch (const std::runtime_error&) {
+                    threw = true;
+                }
+                FaultyWrites::failing = false;
+                return threw;
+            };
+
+            bool autocommitFailed = fails([&] { items.insert({ {"v", "lost"} }); });
+            fdb.beginTransaction();
+            items.insert({ {"v", "lost too"} });
+            bool commitFailed = fails([&] { fdb.commit(); });
+            if (!commitFailed) fdb.rollback();
+            fdb.flushSubscriptions();
+            size_t afterFailures = faultBatches.size();
+            long long keptId = items.insert({ {"v", "kept"} });
+            fdb.flushSubscriptions();
+            auto faultStats = fdb.changeFeedStats();
+            fdb.unsubscribe(faultId);
+            faultOk = autocommitFailed && commitFailed && afterFailures == 0 && faultBatches.size() == 1
+                      && faultBatches[0].size() == 1 && faultBatches[0][0].rowid == keptId
+                      && faultStats.discarded == 2 && items.count() == 1;
+        }
+        for (const char* suffix : {"", "-wal", "-shm"}) std::remove((faultFile + suffix).c_str());
+        if (faultOk) {
+            std::cout << "Change Data Capture After Failed Commit Verified." << std::endl;
+        } else {
+            std::cerr << "Change Data Capture After Failed Commit Failed!" << std::endl;
+        }
+    }
+#if defined(SQLITE_ENABLE_PREUPDATE_HOOK)
+    std::vector<ChangeEvent> valueEvents;
+    subId = db.subscribe("posts", [&](const std::vector<ChangeEvent>& events) {
+        valueEvents.insert(valueEvents.end(), events.begin(), events.end());
+    }, SubscribeOptions{true});
+    cdcId = posts.insert({ {"title", "Before"}, {"user_id", bobId} });
+    posts.update({ {"title", "After"} }, { Condition{"id", Op::EQ, cdcId} });
+    posts.remove({ Condition{"id", Op::EQ, cdcId} });
+    db.flushSubscriptions();
+    db.unsubscribe(subId);
+    if (valueEvents.size() == 3 && valueEvents[1].op == ChangeOp::UPDATE
+        && getCol<std::string>(*valueEvents[1].oldValues, "title") == "Before"
+        && getCol<std::string>(*valueEvents[1].newValues, "title") == "After"
+        && getCol<long long>(*valueEvents[2].oldValues, "id") == cdcId && !valueEvents[2].newValues) {
+        std::cout << "Change Values Verified." << std::endl;
+    } else {
+        std::cerr << "Change Values Failed!" << std::endl;
+    }
+#endif
+
+    // Live query: initial result, then only the delta after relevant commits
+    std::cout << "\n--- Live Queries ---" << std::endl;
+    std::mutex deltaMtx;
+    std::vector<WatchDelta> deltas;
+    WatchOptions watchOpts;
+    watchOpts.debounce = std::chrono::milliseconds(20);
+    auto live = posts.watch({ Condition{"user_id", Op::EQ, bobId} }, {}, [&](const WatchDelta& d) {
+        std::lock_guard<std::mutex> lock(deltaMtx);
+        deltas.push_back(d);
+    }, watchOpts);
+    auto waitForDeliveries = [&](uint64_t n) {
+        for (int i = 0; i < 200 && live->deliveries() < n; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    };
+
+    long long liveId = 0;
+    for (int i = 0; i < 5; ++i) { // Burst of commits, folded by the debounce
+        liveId = posts.insert({ {"title", "Live " + std::to_string(i)}, {"user_id", bobId} });
+    }
+    waitForDeliveries(1);
+    users.update({ {"score", 99.9} }, { Condition{"id", Op::EQ, bobId} }); // Not a dependency
+    posts.update({ {"title", "Live edited"} }, { Condition{"id", Op::EQ, liveId} });
+    waitForDeliveries(2);
+    posts.remove({ Condition{"title", Op::LIKE, "Live%"} });
+    waitForDeliveries(3);
+    uint64_t refreshes = live->refreshes();
+    live->stop();
+
+    std::lock_guard<std::mutex> deltaLock(deltaMtx);
+    if (deltas.size() == 4 && deltas[0].added.size() == 2 && refreshes < 7
+        && deltas[1].added.size() == 5 && deltas[1].removed.empty()
+        && deltas[2].changed.size() == 1 && getCol<std::string>(deltas[2].changed[0], "title") == "Live edited"
+        && deltas[3].removed.size() == 5) {
+        std::cout << "Live Queries Verified (" << refreshes << " refreshes for 7 commits)." << std::endl;
+    } else {
+        std::cerr << "Live Queries Failed!" << std::endl;
+    }
+
+    // WITHOUT ROWID tables never reach the update hook, so watching one (or joining one) throws
+    auto& liveKeys = db.defineTable("live_keys");
+    liveKeys.addColumn("k", SQLType::INTEGER, true).addColumn("user_id", SQLType::INTEGER).withoutRowid().create();
+    QueryOptions keysJoin;
+    keysJoin.joins.push_back({JoinType::INNER, "live_keys", "live_keys.user_id = posts.user_id"});
+    WatchOptions keysWatch;
+    keysWatch.key = {"k"};
+    int watchRejected = 0;
+    try { liveKeys.watch({}, {}, [](const WatchDelta&) {}); } catch (const std::runtime_error&) { ++watchRejected; }
+    try { posts.watch({}, keysJoin, [](const WatchDelta&) {}, keysWatch); } catch (const std::runtime_error&) { ++watchRejected; }
+    if (watchRejected == 2) {
+        std::cout << "Live Query WITHOUT ROWID Rejection Verified." << std::endl;
+    } else {
+        std::cerr << "Live Query WITHOUT ROWID Rejection Failed!" << std::endl;
+    }
+
+    // Materialized view: trigger-maintained GROUP BY must match the live query
+    std::cout << "\n--- Materialized Views ---" << std::endl;
+    auto& sales = db.defineTable("mv_sales");
+    sales.addColumn("id", SQLType::INTEGER, true, true)
+         .addColumn("region", SQLType::TEXT)
+         .addColumn("amount", SQLType::REAL)
+         .create();
+    sales.insert({ {"region", "north"}, {"amount", 10.5} });
+    auto& byRegion = db.defineMaterializedView("mv_sales_by_region", "mv_sales", {"region"}, {
+        {Aggregate::COUNT, "*", ""}, {Aggregate::SUM, "amount", ""},
+        {Aggregate::MIN, "amount", ""}, {Aggregate::MAX, "amount", ""}
+    });
+    long long southId = sales.insert({ {"region", "south"}, {"amount", 4.25} });
+    sales.insert({ {"region", "north"}, {"amount", 2.0} });
+    sales.insert({ {"region", "north"}, {"amount", nullptr} });
+    sales.insert({ {"region", nullptr}, {"amount", 7.0} });
+    long long eastId = sales.insert({ {"region", "east"}, {"amount", 1.0} });
+    sales.update({ {"region", "north"} }, { Condition{"id", Op::EQ, southId} }); // Moves groups
+    sales.remove({ Condition{"amount", Op::EQ, 2.0} });                          // Current north MIN
+    sales.remove({ Condition{"id", Op::EQ, eastId} });                           // Empties a group
+
+    auto viewMatchesLive = [&]() {
+        QueryOptions live;
+        live.columns = {"region", "COUNT(*)", "SUM(amount)", "MIN(amount)", "MAX(amount)"};
+        live.groupBy.push_back("region");
+        live.orderBy = "region";
+        QueryOptions stored;
+        stored.columns = {"region", "count", "sum_amount", "min_amount", "max_amount"};
+        stored.orderBy = "region";
+        auto expected = sales.select({}, live);
+        auto actual = byRegion.select({}, stored);
+        if (expected.size() != actual.size()) return false;
+        for (size_t i = 0; i < expected.size(); ++i) {
+            for (size_t c = 0; c < live.columns.size(); ++c) {
+                if (expected[i].at(live.columns[c]) != actual[i].at(stored.columns[c])) return false;
+            }
+        }
+        return true;
+    };
+    bool incrementalOk = viewMatchesLive();
+    db.rebuildMaterializedView("mv_sales_by_region");
+    if (incrementalOk && viewMatchesLive() && byRegion.count() == 2) {
+        std::cout << "Materialized Views Verified." << std::endl;
+    } else {
+        std::cerr << "Materialized Views Failed!" << std::endl;
+    }
+
     // 4. Sanitization (Reserved Keywords)
     std::cout << "\n--- Sanitization ---" << std::endl;
     // 'group' is a reserved keyword in SQL
@@ -122,4 +509,62 @@ void test_advanced(Database& db) {
     } else {
         std::cerr << "LIKE Operator Failed." << std::endl;
     }
+
+    // 8. Backup & Snapshots
+    std::cout << "\n--- Backup & Snapshots ---" << std::endl;
+    std::remove("test_backup.db");
+    std::remove("test_vacuum.db");
+    int progressCalls = 0;
+    int lastRemaining = -1, lastTotal = -1;
+    auto backupStats = db.backupTo("test_backup.db", 2, std::chrono::milliseconds(0), [&](int remaining, int total) {
+        ++progressCalls;
+        lastRemaining = remaining;
+        lastTotal = total;
+    });
+    long long userCount = users.count();
+    long long backupCount = 0;
+    {
+        Database copy("test_backup.db");
+        copy.defineTable("users");
+        backupCount = copy.getTable("users").count();
+    }
+    auto snapshot = db.snapshotToMemory();
+    users.insert({ {"username", "AfterSnapshot"} });
+    long long snapshotCount = snapshot->getTable("users").count();
+    users.remove({ Condition{"username", Op::EQ, "AfterSnapshot"} });
+    db.vacuumInto("test_vacuum.db");
+    long long vacuumCount = 0;
+    {
+        Database compacted("test_vacuum.db");
+        compacted.defineTable("users");
+        vacuumCount = compacted.getTable("users").count();
+    }
+    if (backupCount == userCount && snapshotCount == userCount && vacuumCount == userCount
+        && backupStats.pages > 0 && progressCalls == backupStats.steps && backupStats.steps > 1
+        && lastRemaining == 0 && lastTotal == backupStats.pages) {
+        std::cout << "Backup & Snapshots Verified (" << backupStats.pages << " pages in " << backupStats.steps << " steps)." << std::endl;
+    } else {
+        std::cerr << "Backup & Snapshots Failed!" << std::endl;
+    }
+    std::remove("test_backup.db");
+    std::remove("test_vacuum.db");
+
+    // Serialized images: read-only clone reads in place, writable clone is independent
+    auto image = db.serialize();
+    auto readOnlyClone = Database::fromImage(image);
+    auto writableClone = Database::fromImage(image, false);
+    bool readOnlyRejected = false;
+    try {
+        readOnlyClone->defineTable("users").insert({ {"username", "NotAllowed"} });
+    } catch (const std::exception&) {
+        readOnlyRejected = true;
+    }
+    writableClone->defineTable("users").insert({ {"username", "CloneOnly"} });
+    if (readOnlyClone->getTable("users").count() == userCount && readOnlyRejected
+        && writableClone->getTable("users").count() == userCount + 1 && users.count() == userCount
+        && writableClone->serialize()->size() >= image->size()) {
+        std::cout << "Serialized Images Verified (" << image->size() << " bytes)." << std::endl;
+    } else {
+        std::cerr << "Serialized Images Failed!" << std::endl;
+    }
 }
@@ -0,0 +1,199 @@
+#include "test_utils.h"
+#include <fstream>
+#include <cstdio>
+#include <sstream>
+
+void test_csv(Database& db) {
+    std::cout << "\n=== Testing CSV Import ===" << std::endl;
+
+    auto& people = db.defineTable("csv_people");
+    people.addColumn("id", SQLType::INTEGER, true, true)
+          .addColumn("name", SQLType::TEXT)
+          .addColumn("age", SQLType::INTEGER)
+          .addColumn("score", SQLType::REAL)
+          .create();
+
+    // Quoted delimiters, escaped quotes, an embedded newline, CRLF and an empty (NULL) field
+    const std::string csvFile = "test_import.csv";
+    {
+        std::ofstream out(csvFile, std::ios::binary);
+        out << "name,age,score\r\n";
+        out << "\"Smith, Anna\",34,1.5\r\n";
+        out << "\"Say \"\"hi\"\"\",,2.25\n";
+        out << "\"Multi\nLine\",7,3\n";
+        for (int i = 0; i < 1000; ++i) {
+            out << "Person" << i << "," << i << "," << i * 0.5 << "\n";
+        }
+    }
+
+    // Tiny chunks force records to be split across chunk and thread boundaries
+    CsvOptions opts;
+    opts.chunkBytes = 64;
+    opts.threads = 4;
+    opts.batchRows = 100;
+    ImportStats stats = db.importCsv(people, csvFile, opts);
+    std::cout << "Imported " << stats.rows << " rows (" << stats.rowsPerSecond() << " rows/s)" << std::endl;
+
+    auto anna = people.select({ Condition{"name", Op::EQ, "Smith, Anna"} });
+    auto hi = people.select({ Condition{"name", Op::EQ, "Say \"hi\""} });
+    auto multi = people.select({ Condition{"name", Op::EQ, "Multi\nLine"} });
+    auto last = people.select({ Condition{"name", Op::EQ, "Person999"} });
+    if (stats.rows == 1003 && anna.size() == 1 && getCol<long long>(anna[0], "age") == 34
+        && hi.size() == 1 && std::holds_alternative<std::nullptr_t>(hi[0]["age"])
+        && multi.size() == 1 && getCol<double>(multi[0], "score") == 3.0
+        && last.size() == 1 && getCol<double>(last[0], "score") == 499.5) {
+        std::cout << "CSV Import Verified." << std::endl;
+    } else {
+        std::cerr << "CSV Import Failed!" << std::endl;
+    }
+
+    // TSV without a header, explicit column list
+    const std::string tsvFile = "test_import.tsv";
+    {
+        std::ofstream out(tsvFile, std::ios::binary);
+        out << "TabUser\t51\t9.75\n";
+    }
+    CsvOptions tsvOpts;
+    tsvOpts.delimiter = '\t';
+    tsvOpts.header = false;
+    tsvOpts.columns = {"name", "age", "score"};
+    db.importCsv(people, tsvFile, tsvOpts);
+    auto tab = people.select({ Condition{"name", Op::EQ, "TabUser"} });
+    if (tab.size() == 1 && getCol<long long>(tab[0], "age") == 51) {
+        std::cout << "TSV Import Verified." << std::endl;
+    } else {
+        std::cerr << "TSV Import Failed!" << std::endl;
+    }
+
+    // A malformed record aborts the import with an error
+    {
+        std::ofstream out(csvFile, std::ios::binary);
+        out << "name,age,score\nBad,1\n";
+    }
+    try {
+        db.importCsv(people, csvFile);
+        std::cerr << "CSV Field Count Check Failed!" << std::endl;
+    } catch (const std::exception& e) {
+        std::cout << "CSV Field Count Check Works (Caught: " << e.what() << ")" << std::endl;
+    }
+
+    // Stray quotes inside unquoted fields are literal: chunk boundaries must not treat
+    // them as opening a quoted field, so the result can't depend on chunkBytes
+    {
+        std::ofstream out(csvFile, std::ios::binary);
+        out << "size,note,n\n";
+        for (int i = 0; i < 200; ++i) out << "5\" pipe,\"multi\nline \"\"" << i << "\"\"\"," << i << "\n";
+    }
+    auto& quotes = db.defineTable("csv_quotes");
+    quotes.addColumn("size", SQLType::TEXT)
+          .addColumn("note", SQLType::TEXT)
+          .addColumn("n", SQLType::INTEGER)
+          .create();
+    bool chunkingStable = true;
+    for (size_t chunkBytes : {size_t(16), size_t(64), size_t(1) << 20}) {
+        quotes.remove({});
+        CsvOptions quoteOpts;
+        quoteOpts.chunkBytes = chunkBytes;
+        quoteOpts.threads = 4;
+        try {
+            ImportStats quoteStats = db.importCsv(quotes, csvFile, quoteOpts);
+            auto row = quotes.select({ Condition{"n", Op::EQ, 137} });
+            chunkingStable = chunkingStable && quoteStats.rows == 200 && row.size() == 1
+                && getCol<std::string>(row[0], "size") == "5\" pipe"
+                && getCol<std::string>(row[0], "note") == "multi\nline \"137\"";
+        } catch (const std::exception& e) {
+            std::cerr << "CSV import with chunkBytes " << chunkBytes << ": " << e.what() << std::endl;
+            chunkingStable = false;
+        }
+    }
+    if (chunkingStable) {
+        std::cout << "CSV Stray Quotes Across Chunks Verified." << std::endl;
+    } else {
+        std::cerr << "CSV Stray Quotes Across Chunks Failed!" << std::endl;
+    }
+
+    std::remove(csvFile.c_str());
+    std::remove(tsvFile.c_str());
+
+    std::cout << "\n=== Testing CSV / NDJSON Export ===" << std::endl;
+
+    // CSV round trip: export, re-import into a copy, compare. An empty name and a NULL
+    // name must stay distinct.
+    people.insert({ {"name", std::string()}, {"age", 5000LL} });
+    people.insert({ {"name", nullptr}, {"age", 5001LL} });
+    {
+        std::ofstream out(csvFile, std::ios::binary);
+        QueryOptions cols;
+        cols.columns = {"name", "age", "score"};
+        size_t exported = people.exportTo(out, ExportFormat::CSV, {}, cols);
+        std::cout << "Exported " << exported << " rows to CSV." << std::endl;
+    }
+    auto& copy = db.defineTable("csv_people_copy");
+    copy.addColumn("id", SQLType::INTEGER, true, true)
+        .addColumn("name", SQLType::TEXT)
+        .addColumn("age", SQLType::INTEGER)
+        .addColumn("score", SQLType::REAL)
+        .create();
+    ImportStats back = db.importCsv(copy, csvFile);
+    auto copiedHi = copy.select({ Condition{"name", Op::EQ, "Say \"hi\""} });
+    auto copiedMulti = copy.select({ Condition{"name", Op::EQ, "Multi\nLine"} });
+    auto copiedEmpty = copy.select({ Condition{"age", Op::EQ, 5000LL} });
+    auto copiedNull = copy.select({ Condition{"age", Op::EQ, 5001LL} });
+    if (back.rows == people.select().size() && copiedHi.size() == 1
+        && std::holds_alternative<std::nullptr_t>(copiedHi[0]["age"]) && copiedMulti.size() == 1
+        && copiedEmpty.size() == 1 && getCol<std::string>(copiedEmpty[0], "name").empty()
+        && !std::holds_alternative<std::nullptr_t>(copiedEmpty[0]["name"])
+        && copiedNull.size() == 1 && std::holds_alternative<std::nullptr_t>(copiedNull[0]["name"])) {
+        std::cout << "CSV Export Round Trip Verified." << std::endl;
+    } else {
+        std::cerr << "CSV Export Round Trip Failed!" << std::endl;
+    }
+    people.remove({ Condition{"age", Op::GT, 4999LL} });
+    std::remove(csvFile.c_str());
+
+    // NDJSON: one object per line, escaped strings, null for NULL
+    std::ostringstream json;
+    QueryOptions jsonOpts;
+    jsonOpts.columns = {"name", "age"};
+    jsonOpts.orderBy = "id";
+    jsonOpts.limit = 3;
+    people.exportTo(json, ExportFormat::NDJSON, {}, jsonOpts);
+    const std::string expected =
+        "{\"name\":\"Smith, Anna\",\"age\":34}\n"
+        "{\"name\":\"Say \\\"hi\\\"\",\"age\":null}\n"
+        "{\"name\":\"Multi\\nLine\",\"age\":7}\n";
+    if (json.str() == expected) {
+        std::cout << "NDJSON Export Verified." << std::endl;
+    } else {
+        std::cerr << "NDJSON Export Failed! Got:\n" << json.str() << std::endl;
+    }
+
+    std::cout << "\n=== Testing Columnar Select & Arrow IPC ===" << std::endl;
+    QueryOptions colOpts;
+    colOpts.columns = {"name", "age", "score"};
+    colOpts.orderBy = "id";
+    colOpts.limit = 3;
+    ColumnarResult columnar = people.selectColumnar({}, colOpts);
+    const auto& names = columnar.column("name");
+    const auto& ages = columnar.column("age");
+    const auto& scores = columnar.column("score");
+    if (columnar.rows == 3 && names.type == SQLType::TEXT && names.text(0) == "Smith, Anna"
+        && ages.type == SQLType::INTEGER && ages.ints[0] == 34 && ages.isNull(1) && ages.nullCount == 1
+        && scores.type == SQLType::REAL && scores.doubles[1] == 2.25) {
+        std::cout << "Columnar Select Verified." << std::endl;
+    } else {
+        std::cerr << "Columnar Select Failed!" << std::endl;
+    }
+
+    // Stream framing: continuation marker first, end-of-stream marker last
+    std::ostringstream ipc;
+    columnar.writeArrowIpc(ipc);
+    std::string bytes = ipc.str();
+    const std::string eos("\xff\xff\xff\xff\0\0\0\0", 8);
+    if (bytes.size() > 16 && bytes.compare(0, 4, "\xff\xff\xff\xff") == 0
+        && bytes.compare(bytes.size() - 8, 8, eos) == 0 && bytes.size() % 8 == 0) {
+        std::cout << "Arrow IPC Stream Written (" << bytes.size() << " bytes)." << std::endl;
+    } else {
+        std::cerr << "Arrow IPC Stream Failed!" << std::endl;
+    }
+}
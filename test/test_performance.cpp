@@ -1,4 +1,689 @@
 #include "test_utils.h"
+#include <cstdio>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+// Composite-PK key/value table: rowid layout vs WITHOUT ROWID clustered b-tree.
+// Each layout gets its own file (rollback journal, so the size is all in the main file).
+static void bench_clustered_tables() {
+    std::cout << "Clustered Tables (rowid vs WITHOUT ROWID, composite PK)..." << std::endl;
+    const int OUTER = 200;
+    const int INNER = 100;
+    const int LOOKUPS = 5000;
+
+    for (bool clustered : {false, true}) {
+        std::string label = clustered ? "WITHOUT ROWID" : "rowid";
+        std::string file = clustered ? "bench_clustered.db" : "bench_rowid.db";
+        std::remove(file.c_str());
+        {
+            Config cfg;
+            cfg.enableWAL = false;
+            Database kvDb(file, cfg);
+            auto& kv = kvDb.defineTable("kv");
+            kv.addColumn("bucket", SQLType::INTEGER, true)
+              .addColumn("key", SQLType::INTEGER, true)
+              .addColumn("value", SQLType::TEXT)
+              .withoutRowid(clustered)
+              .strict()
+              .create();
+
+            {
+                auto txn = kvDb.transaction();
+                for (int b = 0; b < OUTER; ++b) {
+                    for (int k = 0; k < INNER; ++k) {
+                        kv.insert({ {"bucket", b}, {"key", k}, {"value", "v" + std::to_string(b * INNER + k)} });
+                    }
+                }
+                txn.commit();
+            }
+
+            {
+                Timer t("PK Lookup x" + std::to_string(LOOKUPS) + " (" + label + ")");
+                for (int i = 0; i < LOOKUPS; ++i) {
+                    int b = (i * 7919) % OUTER;
+                    int k = (i * 104729) % INNER;
+                    auto rows = kv.select({ Condition{"bucket", Op::EQ, b}, Condition{"key", Op::EQ, k} });
+                    if (rows.size() != 1) std::cerr << "PK Lookup Failed (" << label << ")!" << std::endl;
+                }
+            }
+
+            {
+                Timer t("PK Range Scan x" + std::to_string(OUTER) + " (" + label + ")");
+                for (int b = 0; b < OUTER; ++b) {
+                    auto rows = kv.select({ Condition{"bucket", Op::EQ, b} });
+                    if (rows.size() != INNER) std::cerr << "PK Range Scan Failed (" << label << ")!" << std::endl;
+                }
+            }
+        }
+        std::cout << "File Size (" << label << "): " << std::filesystem::file_size(file) << " bytes" << std::endl;
+        std::remove(file.c_str());
+    }
+
+    // STRICT rejects values that don't match the declared column type
+    std::remove("bench_strict.db");
+    {
+        Database strictDb("bench_strict.db");
+        auto& st = strictDb.defineTable("strict_test");
+        st.addColumn("id", SQLType::INTEGER, true)
+          .addColumn("n", SQLType::INTEGER)
+          .strict()
+          .create();
+        try {
+            st.insert({ {"n", "not a number"} });
+            std::cerr << "STRICT Test Failed! Text stored in INTEGER column." << std::endl;
+        } catch (const std::exception& e) {
+            std::cout << "STRICT Works (Caught: " << e.what() << ")" << std::endl;
+        }
+    }
+    std::remove("bench_strict.db");
+}
+
+// Plain batched inserts vs bulkLoad into a table with two secondary indexes
+static void bench_bulk_load(Database& db) {
+    std::cout << "Bulk Load (indexes dropped and rebuilt)..." << std::endl;
+    const int BULK_ROWS = 100000;
+
+    auto makeRow = [](int i) -> Row {
+        return { {"username", "Bulk" + std::to_string(i)}, {"email", "bulk" + std::to_string(i) + "@example.com"}, {"age", i % 100} };
+    };
+
+    for (bool bulk : {false, true}) {
+        auto& t = db.defineTable(bulk ? "bench_bulk_load" : "bench_bulk_insert");
+        t.addColumn("id", SQLType::INTEGER, true, true)
+         .addColumn("username", SQLType::TEXT)
+         .addColumn("email", SQLType::TEXT)
+         .addColumn("age", SQLType::INTEGER)
+         .create();
+        t.createIndex(t.getName() + "_username", "username", true);
+        t.createIndex(t.getName() + "_age", "age");
+
+        if (bulk) {
+            Timer timer("bulkLoad " + std::to_string(BULK_ROWS) + " rows");
+            int i = 0;
+            size_t loaded = db.bulkLoad(t, [&](Row& row) {
+                if (i >= BULK_ROWS) return false;
+                row = makeRow(i++);
+                return true;
+            });
+            if (loaded != BULK_ROWS) std::cerr << "Bulk Load Failed! Loaded " << loaded << std::endl;
+        } else {
+            Timer timer("Batched Insert " + std::to_string(BULK_ROWS) + " rows (indexes live)");
+            auto txn = db.transaction();
+            for (int i = 0; i < BULK_ROWS; ++i) t.insert(makeRow(i));
+            txn.commit();
+        }
+    }
+
+    // Indexes must be back: the unique one rejects duplicates again
+    auto& loadedTable = db.getTable("bench_bulk_load");
+    try {
+        loadedTable.insert(makeRow(0));
+        std::cerr << "Bulk Load Index Rebuild Failed! Duplicate inserted." << std::endl;
+    } catch (const std::exception&) {
+        std::cout << "Bulk Load Indexes Rebuilt." << std::endl;
+    }
+
+    // A source failing midway keeps committed batches and still restores the indexes
+    BulkLoadOptions opts;
+    opts.batchSize = 1000;
+    int next = BULK_ROWS;
+    try {
+        db.bulkLoad(loadedTable, [&](Row& row) {
+            if (next == BULK_ROWS + 2500) throw std::runtime_error("source interrupted");
+            row = makeRow(next++);
+            return true;
+        }, opts);
+        std::cerr << "Bulk Load Interruption Test Failed! No error raised." << std::endl;
+    } catch (const std::exception& e) {
+        QueryOptions countOpts;
+        countOpts.columns = {"COUNT(*)"};
+        long long count = getCol<long long>(loadedTable.select({}, countOpts)[0], "COUNT(*)");
+        if (count == BULK_ROWS + 2000 && db.recoverBulkLoad() == 0) {
+            std::cout << "Bulk Load Interruption Recovered (" << e.what() << ")." << std::endl;
+        } else {
+            std::cerr << "Bulk Load Interruption Test Failed! Rows: " << count << std::endl;
+        }
+    }
+
+    // A UNIQUE index that can't be rebuilt over the loaded rows fails the load, but the
+    // connection settings still come back
+    auto& dupTable = db.defineTable("bench_bulk_dup");
+    dupTable.addColumn("id", SQLType::INTEGER, true, true)
+            .addColumn("username", SQLType::TEXT)
+            .addColumn("email", SQLType::TEXT)
+            .addColumn("age", SQLType::INTEGER)
+            .create();
+    dupTable.createIndex("bench_bulk_dup_username", "username", true);
+    std::string syncBefore = db.pragma("synchronous"), cacheBefore = db.pragma("cache_size");
+    std::string journalBefore = db.pragma("journal_mode");
+    BulkLoadOptions unsafe;
+    unsafe.disableJournal = true;
+    bool refused = false;
+    try {
+        db.bulkLoad(dupTable, std::vector<Row>{ makeRow(0) }, unsafe);
+    } catch (const std::invalid_argument&) {
+        refused = true;
+    }
+    unsafe.acceptPartialBatch = true;
+    bool rebuildFailed = false;
+    try {
+        db.bulkLoad(dupTable, std::vector<Row>{ makeRow(1), makeRow(1) }, unsafe);
+    } catch (const std::exception&) {
+        rebuildFailed = true;
+    }
+    bool restored = db.pragma("synchronous") == syncBefore && db.pragma("cache_size") == cacheBefore
+                    && db.pragma("journal_mode") == journalBefore;
+    dupTable.remove({ Condition{"id", Op::EQ, 2LL} });
+    if (refused && rebuildFailed && restored && db.recoverBulkLoad() == 1) {
+        std::cout << "Bulk Load Settings Restored After Failed Index Rebuild." << std::endl;
+    } else {
+        std::cerr << "Bulk Load Settings Restore Failed! (refused " << refused << ", rebuild failed "
+                  << rebuildFailed << ", restored " << restored << ")" << std::endl;
+    }
+}
+
+// exportTo streams from the statement; the baseline materializes select() and formats rows
+static void bench_export(Table& users) {
+    std::cout << "Export bench_users (streaming vs select + format)..." << std::endl;
+    const std::string file = "bench_export.out";
+    for (ExportFormat format : {ExportFormat::CSV, ExportFormat::NDJSON}) {
+        std::string label = format == ExportFormat::CSV ? "CSV" : "NDJSON";
+        auto start = std::chrono::high_resolution_clock::now();
+        {
+            std::ofstream out(file, std::ios::binary);
+            users.exportTo(out, format);
+        }
+        std::chrono::duration<double> secs = std::chrono::high_resolution_clock::now() - start;
+        auto bytes = std::filesystem::file_size(file);
+        std::cout << "[Timing] exportTo " << label << ": " << secs.count() * 1000 << " ms ("
+                  << bytes / (1024.0 * 1024.0) / secs.count() << " MB/s)" << std::endl;
+    }
+    {
+        Timer t("select() + format CSV");
+        std::ofstream out(file, std::ios::binary);
+        for (const auto& row : users.select()) {
+            bool first = true;
+            for (const auto& [name, value] : row) {
+                if (!first) out << ",";
+                out << std::visit(ValueToStringVisitor{}, value);
+                first = false;
+            }
+            out << "\n";
+        }
+    }
+    std::remove(file.c_str());
+}
+
+// selectColumnar fills typed buffers; select() builds a std::map per row
+static void bench_columnar(Table& users) {
+    std::cout << "Columnar Select vs Row Select..." << std::endl;
+    {
+        Timer t("select() rows");
+        auto rows = users.select();
+    }
+    ColumnarResult columnar;
+    {
+        Timer t("selectColumnar()");
+        columnar = users.selectColumnar();
+    }
+    {
+        Timer t("Arrow IPC serialization");
+        std::ostringstream out;
+        columnar.writeArrowIpc(out);
+    }
+}
+
+// Column extraction + kernels vs getCol over Row maps, and kernels vs plain loops
+static void bench_column_kernels(Table& users) {
+    std::cout << "Column Extraction & Kernels..." << std::endl;
+    double mapSum = 0.0;
+    {
+        Timer t("select() + getCol<double> sum");
+        for (const auto& row : users.select()) mapSum += getCol<double>(row, "score");
+    }
+    double colSum = 0.0;
+    {
+        Timer t("column<double> + columnSum");
+        colSum = columnSum(users.column<double>("score"));
+    }
+
+    const size_t N = 4000000;
+    std::vector<double> doubles(N);
+    std::vector<int64_t> ints(N);
+    for (size_t i = 0; i < N; ++i) {
+        doubles[i] = static_cast<double>((i * 2654435761u) % 100000) / 100.0;
+        ints[i] = static_cast<int64_t>((i * 2654435761u) % 1000003) - 500000;
+    }
+
+    double scalarSum = 0.0, kernelSum = 0.0;
+    { Timer t("Scalar sum (4M double)"); for (double v : doubles) scalarSum += v; }
+    { Timer t("columnSum (4M double)"); kernelSum = columnSum(doubles); }
+
+    int64_t scalarMin = ints[0], scalarMax = ints[0];
+    std::pair<int64_t, int64_t> kernelMinMax;
+    { Timer t("Scalar min/max (4M int64)"); for (int64_t v : ints) { if (v < scalarMin) scalarMin = v; if (v > scalarMax) scalarMax = v; } }
+    { Timer t("columnMinMax (4M int64)"); kernelMinMax = columnMinMax(ints); }
+
+    std::vector<size_t> scalarHist(100, 0), kernelHist;
+    { Timer t("Scalar histogram (4M double)"); for (double v : doubles) ++scalarHist[std::min<size_t>(static_cast<size_t>(v / 10.0), 99)]; }
+    { Timer t("columnHistogram (4M double)"); kernelHist = columnHistogram(doubles, 0.0, 1000.0, 100); }
+
+    // Integer inputs and values outside the range take the scalar path
+    std::vector<size_t> intHist(10, 0);
+    std::vector<int64_t> negatives;
+    for (int64_t v : ints) {
+        if (v >= -500000 && v <= 500000) ++intHist[std::min<size_t>(static_cast<size_t>((v + 500000) / 100000.0), 9)];
+        if (v < 0) negatives.push_back(v);
+    }
+
+    // Nearest-rank percentiles of 1..100 are the ranks themselves
+    std::vector<int64_t> ranks(100);
+    for (int64_t r = 0; r < 100; ++r) ranks[r] = 100 - r;
+
+    std::vector<double> scalarFiltered, kernelFiltered;
+    { Timer t("Scalar filter > 500 (4M double)"); for (double v : doubles) if (v > 500.0) scalarFiltered.push_back(v); }
+    { Timer t("columnFilter > 500 (4M double)"); kernelFiltered = columnFilter(doubles, Op::GT, 500.0); }
+
+    bool ok = std::abs(mapSum - colSum) < 1e-6 * std::abs(mapSum)
+           && std::abs(scalarSum - kernelSum) < 1e-9 * std::abs(scalarSum)
+           && kernelMinMax.first == scalarMin && kernelMinMax.second == scalarMax
+           && kernelHist == scalarHist && kernelFiltered == scalarFiltered
+           && columnCount(doubles, Op::GT, 500.0) == scalarFiltered.size()
+           && columnHistogram(ints, -500000.0, 500000.0, 10) == intHist
+           && columnFilter(ints, Op::LT, 0) == negatives
+           && columnPercentile(ranks, 0.0) == 1 && columnPercentile(ranks, 0.07) == 7
+           && columnPercentile(ranks, 0.5) == 50 && columnPercentile(ranks, 1.0) == 100
+           && columnPercentile(std::vector<int64_t>{4, 1, 3, 2}, 0.5) == 2;
+    if (ok) {
+        std::cout << "Column Kernels Verified (p50 score: " << columnPercentile(users.column<double>("score"), 0.5) << ")." << std::endl;
+    } else {
+        std::cerr << "Column Kernels Failed!" << std::endl;
+    }
+}
+
+// Heap allocations per call of the hot paths. The column kernels must stay allocation-free;
+// the row paths are compared against the baseline in SQLDB_ALLOC_BASELINE, if given.
+static void check_allocation_budgets(Database& db, Table& users) {
+    std::cout << "Allocation Budgets..." << std::endl;
+    const int CALLS = 200;
+    long long key = 0;
+    auto nextKey = [&] { return 1 + (key++ * 7919) % 1000; };
+
+    std::vector<double> scores = users.column<double>("score");
+    volatile double sink = 0;
+    checkAllocBudget("columnSum", 0, CALLS, [&] { sink = sink + columnSum(scores); });
+    checkAllocBudget("columnMinMax", 0, CALLS, [&] { sink = sink + columnMinMax(scores).first; });
+    checkAllocBudget("columnCount", 0, CALLS, [&] { sink = sink + columnCount(scores, Op::GT, 50.0); });
+
+    checkAllocBaseline("select/point", CALLS, [&] { users.select({ Condition{"id", Op::EQ, nextKey()} }); });
+    checkAllocBaseline("query<T>/point", CALLS, [&] { users.query<BenchUser>({ Condition{"id", Op::EQ, nextKey()} }); });
+    users.enableRowCache();
+    checkAllocBaseline("getById/cached", CALLS, [&] { users.getById(42); });
+    users.disableRowCache();
+    {
+        auto txn = db.transaction(); // Rolled back
+        int n = 0; // Short names stay in the small-string buffer
+        checkAllocBaseline("insert/row", CALLS, [&] {
+            users.insert({ {"username", "B" + std::to_string(n++)}, {"email", "budget@example.com"}, {"age", 1}, {"score", 1.0} });
+        });
+    }
+}
+
+// Point lookups with a Zipfian key distribution: uncached select vs cached getById
+static void bench_row_cache(Table& users, int rowCount) {
+    std::cout << "Row Cache (Zipfian point lookups)..." << std::endl;
+    const int LOOKUPS = 100000;
+    std::mt19937_64 rng(42);
+    ZipfianGenerator zipf(rowCount);
+    std::vector<long long> keys(LOOKUPS);
+    for (auto& k : keys) k = static_cast<long long>(zipf.next(rng)) + 1;
+
+    {
+        Timer t("select by id x" + std::to_string(LOOKUPS));
+        for (long long k : keys) users.select({ Condition{"id", Op::EQ, k} });
+    }
+    users.enableRowCache(1 << 20); // Room for roughly a tenth of the table
+    {
+        Timer t("getById (row cache) x" + std::to_string(LOOKUPS));
+        for (long long k : keys) users.getById(k);
+    }
+    auto st = users.rowCacheStats();
+    std::cout << "Row Cache: hits " << st.hits << ", misses " << st.misses << ", evictions " << st.evictions
+              << ", entries " << st.entries << ", bytes " << st.bytes
+              << " (hit rate " << 100.0 * st.hits / (st.hits + st.misses) << "%)" << std::endl;
+    users.disableRowCache();
+}
+
+// Repeated dashboard-style GROUP BY: uncached vs result cache, then one write invalidating it
+static void bench_result_cache(Database& db, Table& users) {
+    std::cout << "Result Cache (repeated GROUP BY)..." << std::endl;
+    const int REPEATS = 500;
+    QueryOptions opts;
+    opts.columns = {"age", "count(id)", "avg(score)"};
+    opts.groupBy.push_back("age");
+
+    {
+        Timer t("Group By x" + std::to_string(REPEATS) + " (uncached)");
+        for (int i = 0; i < REPEATS; ++i) users.select({ Condition{"age", Op::GT, 10} }, opts);
+    }
+    db.enableResultCache();
+    opts.cache = true;
+    {
+        Timer t("Group By x" + std::to_string(REPEATS) + " (result cache)");
+        for (int i = 0; i < REPEATS; ++i) users.select({ Condition{"age", Op::GT, 10} }, opts);
+    }
+    users.update({ {"score", 50.0} }, { Condition{"id", Op::EQ, 1} });
+    auto fresh = users.select({ Condition{"age", Op::GT, 10} }, opts);
+    auto st = db.resultCacheStats();
+    std::cout << "Result Cache: hits " << st.hits << ", misses " << st.misses
+              << ", invalidations " << st.invalidations << ", bytes " << st.bytes << std::endl;
+    db.disableResultCache();
+}
+
+// Writer cost of change data capture: the commit hook only enqueues, delivery is off-thread
+static void bench_change_feed(Database& db) {
+    std::cout << "Change Data Capture (writer overhead)..." << std::endl;
+    auto& events = db.defineTable("bench_events");
+    events.addColumn("id", SQLType::INTEGER, true, true)
+          .addColumn("payload", SQLType::TEXT)
+          .create();
+
+    const int TXNS = 2000;
+    const int ROWS_PER_TXN = 10;
+    auto writeAll = [&](const std::string& label) {
+        Timer t(label + " " + std::to_string(TXNS) + " txns x " + std::to_string(ROWS_PER_TXN) + " rows");
+        for (int i = 0; i < TXNS; ++i) {
+            auto txn = db.transaction();
+            for (int j = 0; j < ROWS_PER_TXN; ++j) {
+                events.insert({ {"payload", "event " + std::to_string(j)} });
+            }
+            txn.commit();
+        }
+    };
+
+    writeAll("No subscriber:");
+    std::atomic<size_t> received{0};
+    size_t id = db.subscribe("bench_events", [&](const std::vector<ChangeEvent>& batch) { received += batch.size(); });
+    writeAll("Subscribed:");
+    {
+        Timer t("Drain subscriber");
+        db.flushSubscriptions();
+    }
+    db.unsubscribe(id);
+    auto st = db.changeFeedStats();
+    std::cout << "Change Feed: delivered " << received.load() << " events in " << st.transactions
+              << " transactions (callback errors " << st.callbackErrors << ")" << std::endl;
+}
+
+// UI-style refresh: re-running a query after every write vs a debounced live query delta
+static void bench_live_query(Table& users) {
+    std::cout << "Live Query vs Polling..." << std::endl;
+    const int WRITES = 200;
+    std::vector<Condition> where = { Condition{"age", Op::LT, 10} };
+
+    {
+        Timer t("Polling: write + re-select x" + std::to_string(WRITES));
+        for (int i = 0; i < WRITES; ++i) {
+            users.update({ {"score", (double)i} }, { Condition{"id", Op::EQ, 1 + i % 50} });
+            auto rows = users.select(where);
+        }
+    }
+
+    std::atomic<size_t> changedRows{0};
+    WatchOptions watchOpts;
+    watchOpts.debounce = std::chrono::milliseconds(10);
+    auto live = users.watch(where, {}, [&](const WatchDelta& d) { changedRows += d.changed.size(); }, watchOpts);
+    {
+        Timer t("Live query: write x" + std::to_string(WRITES) + " + deltas");
+        for (int i = 0; i < WRITES; ++i) {
+            users.update({ {"score", (double)i + 0.5} }, { Condition{"id", Op::EQ, 1 + i % 50} });
+        }
+        uint64_t seen = live->refreshes();
+        std::this_thread::sleep_for(std::chrono::milliseconds(30)); // Let the last debounce window close
+        while (live->refreshes() != seen) {
+            seen = live->refreshes();
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        }
+    }
+    std::cout << "Live Query: " << live->refreshes() << " refreshes for " << WRITES << " writes, "
+              << changedRows.load() << " changed rows delivered" << std::endl;
+    live->stop();
+}
+
+// GROUP BY age: recomputed on every read vs read from a trigger-maintained summary table
+static void bench_materialized_view(Database& db, Table& users) {
+    std::cout << "Materialized View (Group By Age)..." << std::endl;
+    const int READS = 200;
+    const int WRITES = 1000;
+    QueryOptions live;
+    live.columns = {"age", "COUNT(*)", "SUM(score)", "MAX(score)"};
+    live.groupBy.push_back("age");
+
+    auto writeRows = [&](const std::string& label) {
+        Timer t(label);
+        auto txn = db.transaction();
+        for (int i = 0; i < WRITES; ++i) {
+            users.update({ {"score", (double)(i % 1000) / 10.0} }, { Condition{"id", Op::EQ, 1 + i} });
+        }
+        txn.commit();
+    };
+
+    writeRows("Update x" + std::to_string(WRITES) + " (no view)");
+    {
+        Timer t("Live Group By x" + std::to_string(READS));
+        for (int i = 0; i < READS; ++i) users.select({}, live);
+    }
+
+    Table* view = nullptr;
+    users.createIndex("idx_bench_age", "age"); // MIN/MAX maintenance re-scans a group on delete
+    {
+        Timer t("Define + initial build");
+        view = &db.defineMaterializedView("bench_users_by_age", "bench_users", {"age"}, {
+            {Aggregate::COUNT, "*", ""}, {Aggregate::SUM, "score", ""}, {Aggregate::MAX, "score", ""}
+        });
+    }
+    writeRows("Update x" + std::to_string(WRITES) + " (view maintained)");
+    {
+        Timer t("Materialized view read x" + std::to_string(READS));
+        for (int i = 0; i < READS; ++i) view->select();
+    }
+    {
+        Timer t("Rebuild");
+        db.rebuildMaterializedView("bench_users_by_age");
+    }
+    db.dropMaterializedView("bench_users_by_age");
+}
+
+// Prints p50/p99/max of per-operation latencies in microseconds
+static void reportLatency(const std::string& label, std::vector<double> micros) {
+    std::sort(micros.begin(), micros.end());
+    std::cout << "[Latency] " << label << ": p50 " << micros[micros.size() / 2] << " us, p99 "
+              << micros[micros.size() * 99 / 100] << " us, p99.9 " << micros[micros.size() * 999 / 1000]
+              << " us, max " << micros.back() << " us" << std::endl;
+}
+
+// Writer latency (single-row autocommit updates) alone, during an incremental backup and
+// during a one-shot backup that holds the connection for the whole copy
+static void bench_backup(Database& db, Table& users) {
+    std::cout << "Writer Latency During Backup..." << std::endl;
+    const int WRITES = 2000;
+    const std::string path = "bench_backup.db";
+
+    auto measure = [&](const std::string& label, int pagesPerStep) {
+        std::atomic<bool> writing{true};
+        std::atomic<int> backups{0};
+        std::thread backup;
+        if (pagesPerStep != 0) {
+            backup = std::thread([&] {
+                while (writing) {
+                    db.backupTo(path, pagesPerStep, std::chrono::milliseconds(1));
+                    ++backups;
+                }
+            });
+        }
+        std::vector<double> micros;
+        micros.reserve(WRITES);
+        for (int i = 0; i < WRITES; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            users.update({ {"score", (double)i} }, { Condition{"id", Op::EQ, 1 + i % 1000} });
+            micros.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+        writing = false;
+        if (backup.joinable()) backup.join();
+        reportLatency(label + " (" + std::to_string(backups.load()) + " backups)", micros);
+    };
+
+    measure("No backup", 0);
+    measure("Incremental backup (16 pages/step)", 16);
+    measure("One-shot backup", -1);
+    std::remove(path.c_str());
+}
+
+// Re-opening a fixture file per job vs cloning a serialized image in memory
+static void bench_images(Database& db) {
+    std::cout << "Fixture Open vs Image Clone..." << std::endl;
+    const int OPENS = 50;
+    const std::string path = "bench_fixture.db";
+    std::remove(path.c_str());
+    db.vacuumInto(path);
+
+    long long rows = 0;
+    {
+        Timer t("Open fixture file + scan x" + std::to_string(OPENS));
+        for (int i = 0; i < OPENS; ++i) {
+            Database fixture(path);
+            rows += fixture.defineTable("bench_users").count({ Condition{"score", Op::GT, -1.0} });
+        }
+    }
+    DatabaseImage image;
+    {
+        Timer t("Serialize");
+        image = db.serialize();
+    }
+    {
+        Timer t("Read-only clone + scan x" + std::to_string(OPENS));
+        for (int i = 0; i < OPENS; ++i) {
+            auto clone = Database::fromImage(image);
+            rows += clone->defineTable("bench_users").count({ Condition{"score", Op::GT, -1.0} });
+        }
+    }
+    {
+        Timer t("Writable clone + scan x" + std::to_string(OPENS));
+        for (int i = 0; i < OPENS; ++i) {
+            auto clone = Database::fromImage(image, false);
+            rows += clone->defineTable("bench_users").count({ Condition{"score", Op::GT, -1.0} });
+        }
+    }
+    std::cout << "Image: " << image->size() / 1024 << " KiB, " << rows / (3 * OPENS) << " rows per scan" << std::endl;
+    std::remove(path.c_str());
+}
+
+// Commit latency with SQLite's automatic checkpoint (paid by the committing writer) vs
+// the background checkpointer
+static void bench_checkpointer(Database& db) {
+    std::cout << "WAL Checkpointing (writer commit latency)..." << std::endl;
+    auto& wal = db.defineTable("bench_wal");
+    wal.addColumn("id", SQLType::INTEGER, true, true)
+       .addColumn("payload", SQLType::TEXT)
+       .create();
+    const int COMMITS = 30000;
+    const std::string payload(200, 'x');
+
+    auto measure = [&](const std::string& label) {
+        std::vector<double> micros;
+        micros.reserve(COMMITS);
+        for (int i = 0; i < COMMITS; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            wal.insert({ {"payload", payload} });
+            micros.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+        reportLatency(label, micros);
+    };
+
+    measure("Auto-checkpoint on commit");
+    CheckpointOptions opts;
+    opts.interval = std::chrono::milliseconds(10);
+    opts.walBudgetBytes = 8 << 20;
+    opts.escalation = CheckpointMode::RESTART; // journal_size_limit trims the file instead
+    db.startCheckpointer(opts);
+    measure("Background checkpointer");
+    auto st = db.checkpointStats();
+    db.stopCheckpointer();
+    std::cout << "Checkpointer: " << st.checkpoints << " checkpoints (" << st.escalations << " escalated, "
+              << st.busy << " busy), " << st.framesBackfilled << " frames, max " << st.maxMillis
+              << " ms, WAL " << st.walBytes / 1024 << " KiB" << std::endl;
+}
+
+// The same load / lookup / scan / churn workload under each Config preset, each in a fresh file
+static void bench_config_presets() {
+    std::cout << "Storage Presets..." << std::endl;
+    const int ROWS = 20000;
+    const int LOOKUPS = 5000;
+    const int SINGLE_WRITES = 500;
+    const std::string file = "bench_preset.db";
+    const std::vector<std::pair<std::string, Config>> presets = {
+        {"Default", Config{}},
+        {"ReadHeavy", Config::ReadHeavy()},
+        {"WriteHeavy", Config::WriteHeavy()},
+        {"LowMemory", Config::LowMemory()},
+        {"BulkLoad", Config::BulkLoad()},
+    };
+
+    for (const auto& [label, cfg] : presets) {
+        for (const char* suffix : {"", "-wal", "-shm"}) std::remove((file + suffix).c_str());
+        {
+            Database pdb(file, cfg);
+            auto& items = pdb.defineTable("items");
+            items.addColumn("id", SQLType::INTEGER, true, true)
+                 .addColumn("category", SQLType::INTEGER)
+                 .addColumn("price", SQLType::REAL)
+                 .addColumn("label", SQLType::TEXT)
+                 .create();
+            items.createIndex("idx_items_category", "category");
+
+            {
+                Timer t(label + ": Load " + std::to_string(ROWS) + " rows");
+                auto txn = pdb.transaction();
+                for (int i = 0; i < ROWS; ++i) {
+                    items.insert({ {"category", i % 100}, {"price", (double)(i % 997)},
+                                   {"label", "item_" + std::to_string(i)} });
+                }
+                txn.commit();
+            }
+            {
+                Timer t(label + ": Point lookups x" + std::to_string(LOOKUPS));
+                for (int i = 0; i < LOOKUPS; ++i) {
+                    auto row = items.getById(1 + (i * 7919) % ROWS);
+                    if (!row) std::cerr << "Preset Lookup Failed (" << label << ")!" << std::endl;
+                }
+            }
+            {
+                Timer t(label + ": Category scans x100 (ORDER BY price)");
+                QueryOptions opts;
+                opts.orderBy = "price";
+                for (int c = 0; c < 100; ++c) {
+                    auto rows = items.select({ Condition{"category", Op::EQ, c} }, opts);
+                    if (rows.size() != ROWS / 100) std::cerr << "Preset Scan Failed (" << label << ")!" << std::endl;
+                }
+            }
+            {
+                Timer t(label + ": Autocommit inserts x" + std::to_string(SINGLE_WRITES));
+                for (int i = 0; i < SINGLE_WRITES; ++i) {
+                    items.insert({ {"category", i % 100}, {"price", 1.0}, {"label", "single"} });
+                }
+            }
+            {
+                Timer t(label + ": Delete half + incremental vacuum");
+                items.remove({ Condition{"id", Op::LT, ROWS / 2} });
+                pdb.incrementalVacuum();
+            }
+        }
+        std::cout << label << ": file " << std::filesystem::file_size(file) / 1024 << " KiB" << std::endl;
+    }
+    for (const char* suffix : {"", "-wal", "-shm"}) std::remove((file + suffix).c_str());
+}
 
 void test_performance(Database& db) {
     std::cout << "\n=== Performance & Timing Tests ===" << std::endl;
@@ -61,4 +746,93 @@ void test_performance(Database& db) {
         // We aren't checking result correctness here, just timing execution
         auto result = users.select({}, opts);
     }
+    {
+        Timer t("Group By Age (countBy)");
+        auto groups = users.countBy<int>("age");
+    }
+
+    // Counting rows: materializing select() vs COUNT(*) on a cached statement
+    size_t selectedCount = 0;
+    long long countedRows = 0;
+    {
+        Timer t("Count via select().size()");
+        selectedCount = users.select({ Condition{"age", Op::GT, 50} }).size();
+    }
+    {
+        Timer t("Count via count()");
+        countedRows = users.count({ Condition{"age", Op::GT, 50} });
+    }
+    if (countedRows == static_cast<long long>(selectedCount)) {
+        std::cout << "Count Verified (" << countedRows << " rows)." << std::endl;
+    } else {
+        std::cerr << "Count Failed! count() " << countedRows << " vs select() " << selectedCount << std::endl;
+    }
+
+    check_allocation_budgets(db, users);
+    bench_row_cache(users, ROW_COUNT);
+    bench_result_cache(db, users);
+    bench_change_feed(db);
+    bench_live_query(users);
+    bench_materialized_view(db, users);
+    bench_backup(db, users);
+    bench_images(db);
+    bench_checkpointer(db);
+    bench_config_presets();
+    bench_export(users);
+    bench_columnar(users);
+    bench_column_kernels(users);
+
+    // Cascading Deletes: unindexed vs indexed foreign key child column
+    std::cout << "Cascading Deletes (FK index vs none)..." << std::endl;
+    const int PARENT_COUNT = 2000;
+    const int CHILDREN_PER_PARENT = 10;
+    const int DELETE_COUNT = 200;
+
+    for (bool indexed : {false, true}) {
+        std::string suffix = indexed ? "_idx" : "_noidx";
+        auto& parents = db.defineTable("bench_parents" + suffix);
+        parents.addColumn("id", SQLType::INTEGER, true, true)
+               .addColumn("name", SQLType::TEXT)
+               .create();
+
+        auto& children = db.defineTable("bench_children" + suffix);
+        children.addColumn("id", SQLType::INTEGER, true, true)
+                .addForeignKey("parent_id", SQLType::INTEGER, "bench_parents" + suffix, "id", true)
+                .indexForeignKeys(indexed)
+                .create();
+
+        {
+            auto txn = db.transaction();
+            for (int i = 0; i < PARENT_COUNT; ++i) {
+                long long pid = parents.insert({ {"name", "Parent" + std::to_string(i)} });
+                for (int c = 0; c < CHILDREN_PER_PARENT; ++c) {
+                    children.insert({ {"parent_id", pid} });
+                }
+            }
+            txn.commit();
+        }
+
+        Timer t(std::string("Cascade Delete ") + std::to_string(DELETE_COUNT) + " parents" + (indexed ? " (FK Index)" : " (No FK Index)"));
+        auto txn = db.transaction();
+        for (int i = 1; i <= DELETE_COUNT; ++i) {
+            parents.remove({ Condition{"id", Op::EQ, i} });
+        }
+        txn.commit();
+    }
+
+    auto missing = db.validateForeignKeyIndexes();
+    bool flagsNoIdx = false, flagsIdx = false;
+    for (const auto& fk : missing) {
+        std::cout << "Unindexed FK: " << fk.table << "(" << fk.columns[0] << ") -> " << fk.refTable << std::endl;
+        if (fk.table == "bench_children_noidx") flagsNoIdx = true;
+        if (fk.table == "bench_children_idx") flagsIdx = true;
+    }
+    if (flagsNoIdx && !flagsIdx) {
+        std::cout << "FK Index Validation Verified." << std::endl;
+    } else {
+        std::cerr << "FK Index Validation Failed!" << std::endl;
+    }
+
+    bench_clustered_tables();
+    bench_bulk_load(db);
 }
@@ -1,4 +1,6 @@
 #include "test_utils.h"
+#include <cstdio>
+#include <thread>
 
 void test_transactions(Database& db) {
     std::cout << "\n=== Testing Transaction Support ===" << std::endl;
@@ -23,14 +25,14 @@ void test_transactions(Database& db) {
 
     // 2. Rollback (Destructor)
     std::cout << "Testing Rollback (via Destructor)..." << std::endl;
-    int countBefore = table.select().size();
+    long long countBefore = table.count();
     {
         auto txn = db.transaction();
         table.insert({ {"val", 200} });
         // No commit() -> Rollback
     }
     
-    int countAfter = table.select().size();
+    long long countAfter = table.count();
     if (countAfter == countBefore) {
         std::cout << "Rollback Works. Row count unchanged." << std::endl;
     } else {
@@ -49,4 +51,252 @@ void test_transactions(Database& db) {
     } else {
          std::cerr << "Explicit Rollback Failed." << std::endl;
     }
+
+    // 4. Background WAL checkpoints (budget 0: any log escalates to RESTART, once; a reader
+    // pinning an old snapshot makes the escalation come back busy)
+    std::cout << "Testing Background Checkpoints..." << std::endl;
+    CheckpointOptions cpOpts;
+    cpOpts.interval = std::chrono::milliseconds(5);
+    cpOpts.walBudgetBytes = 0;
+    cpOpts.escalation = CheckpointMode::RESTART;
+    cpOpts.busyTimeout = std::chrono::milliseconds(20);
+    std::string sizeLimitBefore = db.pragma("journal_size_limit");
+    db.startCheckpointer(cpOpts);
+    bool sizeLimited = db.pragma("journal_size_limit") == "0";
+    for (int i = 0; i < 50; ++i) table.insert({ {"val", 400 + i} });
+    auto cp = db.checkpointStats();
+    for (int i = 0; i < 200 && cp.escalations == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        cp = db.checkpointStats();
+    }
+    // The RESTARTed log keeps its length until the next write, which must not re-escalate
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto idle = db.checkpointStats();
+    bool escalatedOnce = cp.escalations >= 1 && cp.framesBackfilled > 0
+                         && idle.escalations == cp.escalations && idle.checkpoints > cp.checkpoints;
+
+    sqlite3* reader = nullptr;
+    sqlite3_open_v2("test_suite.db", &reader, SQLITE_OPEN_READONLY, nullptr);
+    bool pinned = sqlite3_exec(reader, "BEGIN; SELECT count(*) FROM txn_test;", nullptr, nullptr, nullptr) == SQLITE_OK;
+    for (int i = 0; i < 50; ++i) table.insert({ {"val", 450 + i} });
+    auto busy = db.checkpointStats();
+    for (int i = 0; i < 200 && busy.escalations == idle.escalations; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        busy = db.checkpointStats();
+    }
+    sqlite3_exec(reader, "COMMIT;", nullptr, nullptr, nullptr);
+    sqlite3_close(reader);
+    db.stopCheckpointer();
+    if (sizeLimited && escalatedOnce && pinned && busy.busy >= 1 && busy.escalations > idle.escalations
+        && db.checkpointStats().checkpoints == 0 && db.pragma("journal_size_limit") == sizeLimitBefore
+        && table.count({ Condition{"val", Op::GT, 399} }) == 100) {
+        std::cout << "Background Checkpoints Work (" << busy.checkpoints << " checkpoints, "
+                  << busy.escalations << " escalated, " << busy.busy << " busy behind a reader, "
+                  << busy.framesBackfilled << " frames backfilled)." << std::endl;
+    } else {
+        std::cerr << "Background Checkpoints Failed." << std::endl;
+    }
+
+    // 4b. Connection lock telemetry
+    std::cout << "Testing Lock Stats..." << std::endl;
+    db.resetLockStats();
+    {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 4; ++t) {
+            workers.emplace_back([&table] {
+                for (int i = 0; i < 100; ++i) table.count({ Condition{"val", Op::GT, 0} });
+            });
+        }
+        for (auto& w : workers) w.join();
+    }
+    auto ls = db.lockStats();
+    auto site = std::find_if(ls.sites.begin(), ls.sites.end(),
+                             [](const LockSiteStats& s) { return s.site == "Table::scalarQuery"; });
+    if (ls.acquisitions >= 400 && ls.contended <= ls.acquisitions && (ls.contended == 0 || ls.waitNanos > 0)
+        && ls.holdNanos > 0 && site != ls.sites.end() && site->acquisitions >= 400 && ls.queueDepth == 0
+        && ls.priority(LockPriority::INTERACTIVE).acquisitions == ls.acquisitions) {
+        std::cout << "Lock Stats Verified (" << ls.acquisitions << " acquisitions, " << ls.contended
+                  << " contended, " << ls.waitNanos / 1000 << " us waited, " << ls.holdNanos / 1000
+                  << " us held, " << ls.sites.size() << " sites)." << std::endl;
+    } else {
+        std::cerr << "Lock Stats Failed." << std::endl;
+    }
+
+    // Queued interactive requests are served before earlier batch ones
+    std::cout << "Testing Lock Priority..." << std::endl;
+    {
+        ContextMutex mtx;
+        std::vector<std::string> order;
+        mtx.lock("holder");
+        auto waitForQueue = [&](size_t depth) {
+            while (mtx.stats().queueDepth < depth) std::this_thread::yield();
+        };
+        std::thread batch([&] {
+            LockPriorityScope scope(LockPriority::BATCH);
+            ContextLock lock(mtx, "batch");
+            order.push_back("batch");
+        });
+        waitForQueue(1);
+        std::thread interactive([&] {
+            ContextLock lock(mtx, "interactive");
+            order.push_back("interactive");
+        });
+        waitForQueue(2);
+        mtx.unlock();
+        batch.join();
+        interactive.join();
+        auto ps = mtx.stats();
+        if (order == std::vector<std::string>{"interactive", "batch"} && ps.maxQueueDepth == 2
+            && ps.priority(LockPriority::BATCH).contended == 1 && ps.sites.size() == 3) {
+            std::cout << "Lock Priority Verified." << std::endl;
+        } else {
+            std::cerr << "Lock Priority Failed." << std::endl;
+        }
+    }
+
+    // 4c. Operation metrics, recorded from two threads and merged on read
+    std::cout << "Testing Operation Metrics..." << std::endl;
+    db.enableMetrics();
+    db.resetMetrics();
+    {
+        auto work = [&table](int base) {
+            for (int i = 0; i < 50; ++i) {
+                table.insert({ {"val", 1000 + base + i} });
+                table.select({ Condition{"val", Op::EQ, 1000 + base + i} });
+            }
+        };
+        std::thread other(work, 100);
+        work(0);
+        other.join();
+        auto txn = db.transaction();
+        table.update({ {"val", 999} }, { Condition{"val", Op::GT, 1099} });
+        table.remove({ Condition{"val", Op::EQ, 999} });
+        txn.commit();
+    }
+    db.disableMetrics();
+    table.select({ Condition{"val", Op::EQ, 1} }); // Not recorded
+    auto m = db.metricsSnapshot();
+    const auto& selTotal = m.get(MetricOp::SELECT, MetricPhase::TOTAL);
+    std::string text = db.metricsText();
+    if (m.get(MetricOp::INSERT, MetricPhase::TOTAL).count() == 100 && selTotal.count() == 100
+        && m.get(MetricOp::SELECT, MetricPhase::MATERIALIZE).count() == 100
+        && m.get(MetricOp::SELECT, MetricPhase::LOCK_WAIT).count() == 100
+        && m.get(MetricOp::UPDATE, MetricPhase::STEP).count() == 1
+        && m.get(MetricOp::REMOVE, MetricPhase::TOTAL).count() == 1
+        && m.get(MetricOp::COMMIT, MetricPhase::TOTAL).count() == 1
+        && selTotal.percentileMicros(0.5) <= selTotal.percentileMicros(0.99)
+        && selTotal.percentileMicros(0.99) <= selTotal.maxMicros()
+        && text.find("sqldb_op_duration_seconds_count{op=\"select\",phase=\"total\"} 100") != std::string::npos
+        && text.find("le=\"+Inf\"") != std::string::npos) {
+        std::cout << "Operation Metrics Verified (select p50 " << selTotal.percentileMicros(0.5) << " us, p99 "
+                  << selTotal.percentileMicros(0.99) << " us)." << std::endl;
+    } else {
+        std::cerr << "Operation Metrics Failed." << std::endl;
+    }
+    table.remove({ Condition{"val", Op::GT, 999} });
+
+    // 4d. Time budgets and cancellation of a runaway three-way cross join
+    std::cout << "Testing Query Cancellation..." << std::endl;
+    {
+        Config cfg;
+        cfg.queryTimeoutMs = 50;
+        Database slowDb(":memory:", cfg);
+        for (const char* name : {"r1", "r2", "r3"}) {
+            auto& t = slowDb.defineTable(name);
+            t.addColumn("id", SQLType::INTEGER, true, true).create();
+            auto txn = slowDb.transaction();
+            for (int i = 0; i < 1000; ++i) t.insert({ {"id", i + 1} });
+            txn.commit();
+        }
+        auto& r1 = slowDb.getTable("r1");
+        QueryOptions runaway;
+        runaway.columns = {"COUNT(*)"};
+        runaway.joins = { {JoinType::CROSS, "r2", "1"}, {JoinType::CROSS, "r3", "1"} };
+
+        auto outcome = [&](const QueryOptions& opts) -> std::string {
+            try {
+                r1.select({}, opts);
+                return "finished";
+            } catch (const QueryTimeout&) {
+                return "timeout";
+            } catch (const QueryCancelled&) {
+                return "cancelled";
+            }
+        };
+        auto started = std::chrono::steady_clock::now();
+        std::string byDefault = outcome(runaway);
+
+        QueryOptions timed = runaway;
+        timed.timeout = std::chrono::milliseconds(20);
+        std::string byOption = outcome(timed);
+
+        QueryOptions tokened = runaway;
+        tokened.timeout = std::chrono::milliseconds(-1);
+        tokened.cancel = std::make_shared<CancellationToken>();
+        std::thread canceller([token = tokened.cancel] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            token->cancel();
+        });
+        std::string byToken = outcome(tokened);
+        canceller.join();
+
+        QueryOptions unlimited = runaway;
+        unlimited.timeout = std::chrono::milliseconds(-1);
+        std::atomic<bool> stopped{false};
+        std::thread watchdog([&] {
+            // interrupt() only affects a statement already running, so repeat until it lands
+            while (!stopped) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                slowDb.interrupt();
+            }
+        });
+        std::string byInterrupt = outcome(unlimited);
+        stopped = true;
+        watchdog.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+        auto cs = slowDb.cancellationStats();
+        if (byDefault == "timeout" && byOption == "timeout" && byToken == "cancelled" && byInterrupt == "cancelled"
+            && seconds < 5.0 && cs.timeouts == 2 && cs.cancellations == 2
+            && cs.lostNanos >= 80000000ull && cs.maxLostNanos <= cs.lostNanos && r1.count() == 1000) {
+            std::cout << "Query Cancellation Verified (" << cs.lostNanos / 1000000 << " ms lost to "
+                      << cs.timeouts + cs.cancellations << " stopped queries)." << std::endl;
+        } else {
+            std::cerr << "Query Cancellation Failed (" << byDefault << ", " << byOption << ", " << byToken
+                      << ", " << byInterrupt << ")." << std::endl;
+        }
+    }
+
+    // 5. Storage tuning: page size and auto-vacuum only take on a fresh file
+    std::cout << "Testing Storage Settings..." << std::endl;
+    const std::string tunedFile = "test_tuned.db";
+    std::remove(tunedFile.c_str());
+    {
+        Config cfg = Config::LowMemory();
+        cfg.pageSize = 8192;
+        cfg.busyTimeoutMs = 1234;
+        Database tuned(tunedFile, cfg);
+        auto& blobs = tuned.defineTable("blobs");
+        blobs.addColumn("id", SQLType::INTEGER, true, true)
+             .addColumn("data", SQLType::TEXT)
+             .create();
+        {
+            auto txn = tuned.transaction();
+            for (int i = 0; i < 200; ++i) blobs.insert({ {"data", std::string(4000, 'x')} });
+            txn.commit();
+        }
+        blobs.remove({ Condition{"id", Op::GT, 0} });
+        long long released = tuned.incrementalVacuum();
+        if (tuned.pragma("page_size") == "8192" && tuned.pragma("auto_vacuum") == "2"
+            && tuned.pragma("cache_size") == "-512" && tuned.pragma("mmap_size") == "0"
+            && tuned.pragma("temp_store") == "1" && tuned.pragma("wal_autocheckpoint") == "250"
+            && tuned.pragma("busy_timeout") == "1234" && released > 0 && tuned.pragma("freelist_count") == "0") {
+            std::cout << "Storage Settings Verified (" << released << " pages released)." << std::endl;
+        } else {
+            std::cerr << "Storage Settings Failed." << std::endl;
+        }
+    }
+    std::remove(tunedFile.c_str());
+    std::remove((tunedFile + "-wal").c_str());
+    std::remove((tunedFile + "-shm").c_str());
 }
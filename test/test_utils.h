@@ -4,7 +4,17 @@
 #include <string>
 #include <chrono>
 #include <algorithm>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
 #include "sqldb/sqldb.h"
+#include "bench/alloc_counter.h"
+#include "bench/key_generators.h"
+
+using namespace sqldb;
 
 // ==========================================
 // Utilities
@@ -24,6 +34,96 @@ public:
     }
 };
 
+// Heap allocations per call of 'op', averaged over 'calls' calls after one warm-up call
+template<typename Fn>
+bench::AllocCounts measureAllocs(int calls, Fn&& op) {
+    op(); // Warm statement and row caches
+    bench::AllocScope scope;
+    for (int i = 0; i < calls; ++i) op();
+    return scope.delta();
+}
+
+// Checks that 'op' makes at most 'budget' heap allocations per call on average over
+// 'calls' calls. Needs a build with SQLDB_COUNT_ALLOCATIONS; otherwise it only reports
+// that it was skipped.
+template<typename Fn>
+void checkAllocBudget(const std::string& label, double budget, int calls, Fn&& op) {
+    if (!bench::allocCountingEnabled) {
+        std::cout << "Allocation Budget Skipped (" << label << ", no SQLDB_COUNT_ALLOCATIONS)" << std::endl;
+        return;
+    }
+    auto used = measureAllocs(calls, op);
+    double perCall = static_cast<double>(used.allocations) / calls;
+    if (perCall <= budget) {
+        std::cout << "Allocation Budget Verified (" << label << ": " << perCall << " allocs, "
+                  << used.bytes / calls << " bytes per call, budget " << budget << ")" << std::endl;
+    } else {
+        std::cerr << "Allocation Budget Failed! " << label << ": " << perCall
+                  << " allocs per call, budget " << budget << std::endl;
+    }
+}
+
+// Allocation baselines for checkAllocBaseline, "name allocs_per_call" per line like the
+// bench baselines. SQLDB_ALLOC_BASELINE names the file to compare against and
+// SQLDB_ALLOC_SAVE_BASELINE the file this run's counts are written to.
+inline const std::map<std::string, double>& allocBaseline() {
+    static const std::map<std::string, double> entries = [] {
+        std::map<std::string, double> loaded;
+        const char* path = std::getenv("SQLDB_ALLOC_BASELINE");
+        if (!path || !*path) return loaded;
+        std::ifstream in(path);
+        if (!in) throw std::runtime_error(std::string("Cannot open allocation baseline ") + path);
+        std::string line, name;
+        double perCall = 0.0;
+        while (std::getline(in, line)) {
+            std::istringstream fields(line);
+            if (line.empty() || line[0] == '#' || !(fields >> name >> perCall)) continue;
+            loaded[name] = perCall;
+        }
+        return loaded;
+    }();
+    return entries;
+}
+
+inline void saveAllocBaseline(const std::string& name, double perCall) {
+    static std::ofstream out = [] {
+        const char* path = std::getenv("SQLDB_ALLOC_SAVE_BASELINE");
+        std::ofstream file;
+        if (path && *path) {
+            file.open(path);
+            if (!file) throw std::runtime_error(std::string("Cannot write allocation baseline ") + path);
+            file << "# name allocs_per_call\n";
+        }
+        return file;
+    }();
+    if (out.is_open()) out << name << " " << perCall << std::endl;
+}
+
+// Checks that 'op' allocates no more per call than the baseline recorded for 'name' (no
+// spaces). Without a baseline entry the count is only reported. Like the bench baselines,
+// half an allocation per call of slack absorbs setup amortized into the average.
+template<typename Fn>
+void checkAllocBaseline(const std::string& name, int calls, Fn&& op) {
+    if (!bench::allocCountingEnabled) {
+        std::cout << "Allocation Baseline Skipped (" << name << ", no SQLDB_COUNT_ALLOCATIONS)" << std::endl;
+        return;
+    }
+    auto used = measureAllocs(calls, op);
+    double perCall = static_cast<double>(used.allocations) / calls;
+    saveAllocBaseline(name, perCall);
+    auto base = allocBaseline().find(name);
+    if (base == allocBaseline().end()) {
+        std::cout << "Allocation Count (" << name << ": " << perCall << " allocs, "
+                  << used.bytes / calls << " bytes per call, no baseline)" << std::endl;
+    } else if (perCall <= base->second + 0.5) {
+        std::cout << "Allocation Baseline Verified (" << name << ": " << perCall << " allocs per call, baseline "
+                  << base->second << ")" << std::endl;
+    } else {
+        std::cerr << "Allocation Baseline Failed! " << name << ": " << perCall
+                  << " allocs per call, baseline " << base->second << std::endl;
+    }
+}
+
 // ==========================================
 // Data Structures & ORM
 // ==========================================
@@ -49,7 +149,7 @@ struct BenchUser {
 
 // Map UserStruct to 'users' table
 template<>
-struct ORM<UserStruct> {
+struct sqldb::ORM<UserStruct> {
     static constexpr const char* table = "users";
     static auto map() {
         return std::make_tuple(
@@ -62,7 +162,7 @@ struct ORM<UserStruct> {
 
 // Map UserInput to 'users' table (for insertion without ID)
 template<>
-struct ORM<UserInput> {
+struct sqldb::ORM<UserInput> {
     static constexpr const char* table = "users";
     static auto map() {
         return std::make_tuple(
@@ -73,7 +173,7 @@ struct ORM<UserInput> {
 };
 
 template<>
-struct ORM<BenchUser> {
+struct sqldb::ORM<BenchUser> {
     static constexpr const char* table = "bench_users";
     static auto map() {
         return std::make_tuple(
@@ -94,4 +194,5 @@ void test_basics(Database& db);
 void test_orm(Database& db);
 void test_advanced(Database& db);
 void test_transactions(Database& db);
+void test_csv(Database& db);
 void test_performance(Database& db);